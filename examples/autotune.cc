@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ucxpp/ucxpp.h>
+
+constexpr ucp_tag_t k_tune_tag = 0x7E57A070;
+
+struct tune_options {
+  std::vector<size_t> message_sizes = {8, 1024, 16384, 131072, 1048576};
+  std::vector<std::string> rndv_thresholds = {"auto", "1k",   "8k",
+                                              "32k",  "128k", "512k"};
+  std::vector<std::string> zcopy_thresholds = {"auto", "1k", "8k", "32k",
+                                               "128k"};
+  std::vector<std::string> transports = {""};
+  size_t bytes_per_size = 64 * 1024 * 1024;
+  size_t max_iterations = 100000;
+  size_t window = 16;
+  std::string output = "ucxpp.profile";
+};
+
+struct candidate {
+  std::string rndv_thresh;
+  std::string zcopy_thresh;
+  std::string transports;
+};
+
+struct loopback_run {
+  size_t total;
+  size_t posted_sends = 0;
+  size_t posted_recvs = 0;
+  size_t received = 0;
+  size_t active = 0;
+};
+
+static std::vector<std::string> split(std::string const &s, char delim) {
+  std::vector<std::string> parts;
+  std::stringstream ss(s);
+  std::string part;
+  while (std::getline(ss, part, delim)) {
+    if (!part.empty()) {
+      parts.push_back(part);
+    }
+  }
+  return parts;
+}
+
+ucxpp::task<void> sender(std::shared_ptr<ucxpp::endpoint> ep, void *buffer,
+                         size_t message_size, loopback_run &run) {
+  while (run.posted_sends < run.total) {
+    run.posted_sends++;
+    co_await ep->tag_send(buffer, message_size, k_tune_tag);
+  }
+  run.active--;
+}
+
+ucxpp::task<void> receiver(std::shared_ptr<ucxpp::worker> worker,
+                           void *buffer, size_t message_size,
+                           loopback_run &run) {
+  while (run.posted_recvs < run.total) {
+    run.posted_recvs++;
+    co_await worker->tag_recv(buffer, message_size, k_tune_tag);
+    run.received++;
+  }
+  run.active--;
+}
+
+ucxpp::task<void> close_all(std::shared_ptr<ucxpp::worker> worker,
+                            bool &closed) {
+  co_await worker->close_all();
+  closed = true;
+}
+
+/* Returns the average nanoseconds per message for one message size */
+static double measure(std::shared_ptr<ucxpp::worker> send_worker,
+                      std::shared_ptr<ucxpp::worker> recv_worker,
+                      std::shared_ptr<ucxpp::endpoint> ep,
+                      std::vector<void *> const &send_buffers,
+                      std::vector<void *> const &recv_buffers,
+                      size_t message_size, size_t iterations) {
+  loopback_run run{iterations};
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < send_buffers.size(); ++i) {
+    run.active += 2;
+    receiver(recv_worker, recv_buffers[i], message_size, run).detach();
+    sender(ep, send_buffers[i], message_size, run).detach();
+  }
+  while (run.active > 0) {
+    send_worker->progress();
+    recv_worker->progress();
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+static std::vector<double> run_candidate(candidate const &c,
+                                         tune_options const &options) {
+  auto builder = ucxpp::context::builder();
+  builder.enable_tag()
+      .set_config("RNDV_THRESH", c.rndv_thresh)
+      .set_config("ZCOPY_THRESH", c.zcopy_thresh);
+  if (!c.transports.empty()) {
+    builder.transports(c.transports);
+  }
+  auto ctx = builder.build();
+  auto send_worker = std::make_shared<ucxpp::worker>(ctx);
+  auto recv_worker = std::make_shared<ucxpp::worker>(ctx);
+  auto address = recv_worker->get_address();
+  auto address_bytes = reinterpret_cast<char const *>(address.get_address());
+  auto peer = ucxpp::remote_address(std::vector<char>(
+      address_bytes, address_bytes + address.get_length()));
+  auto ep = std::make_shared<ucxpp::endpoint>(send_worker, peer);
+
+  auto max_size = *std::max_element(options.message_sizes.begin(),
+                                    options.message_sizes.end());
+  std::vector<ucxpp::local_memory_handle> mrs;
+  std::vector<void *> send_buffers, recv_buffers;
+  for (size_t i = 0; i < options.window; ++i) {
+    auto [send_buffer, send_mr] =
+        ucxpp::local_memory_handle::allocate_mem(ctx, max_size);
+    auto [recv_buffer, recv_mr] =
+        ucxpp::local_memory_handle::allocate_mem(ctx, max_size);
+    send_buffers.push_back(send_buffer);
+    recv_buffers.push_back(recv_buffer);
+    mrs.push_back(std::move(send_mr));
+    mrs.push_back(std::move(recv_mr));
+  }
+
+  std::vector<double> results;
+  for (auto size : options.message_sizes) {
+    auto iterations = std::clamp<size_t>(options.bytes_per_size / size,
+                                         options.window * 4,
+                                         options.max_iterations);
+    measure(send_worker, recv_worker, ep, send_buffers, recv_buffers, size,
+            iterations / 10);
+    results.push_back(measure(send_worker, recv_worker, ep, send_buffers,
+                              recv_buffers, size, iterations));
+  }
+
+  bool closed = false;
+  close_all(send_worker, closed).detach();
+  while (!closed) {
+    send_worker->progress();
+    recv_worker->progress();
+  }
+  return results;
+}
+
+static void write_profile(std::string const &filename, candidate const &c,
+                          tune_options const &options, double score) {
+  std::ofstream file(filename);
+  file << "# Generated by ucxpp autotune\n";
+  file << "# Message sizes:";
+  for (auto size : options.message_sizes) {
+    file << " " << size;
+  }
+  file << "\n# Relative cost to defaults: " << score << "\n";
+  file << "UCX_RNDV_THRESH=" << c.rndv_thresh << "\n";
+  file << "UCX_ZCOPY_THRESH=" << c.zcopy_thresh << "\n";
+  if (!c.transports.empty()) {
+    file << "UCX_TLS=" << c.transports << "\n";
+  }
+}
+
+void print_usage(char const *argv0) {
+  ::fprintf(stderr,
+            "Usage: %s [options]\n"
+            "-s\tComma-separated message sizes (default: "
+            "8,1024,16384,131072,1048576)\n"
+            "-r\tComma-separated RNDV_THRESH candidates\n"
+            "-z\tComma-separated ZCOPY_THRESH candidates\n"
+            "-T\tSemicolon-separated TLS candidates (default: environment)\n"
+            "-b\tBytes transferred per message size (default: 64MB)\n"
+            "-n\tMaximum iterations per message size (default: 100000)\n"
+            "-o\tConcurrent requests (default: 16)\n"
+            "-f\tOutput profile file (default: ucxpp.profile)\n",
+            argv0);
+}
+
+int main(int argc, char *argv[]) {
+  auto args = std::vector<std::string>(argv + 1, argv + argc);
+  tune_options options;
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "-h") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (i + 1 >= args.size()) {
+      ::fprintf(stderr, "missing value for option: %s\n", args[i].c_str());
+      return 1;
+    } else if (args[i] == "-s") {
+      options.message_sizes.clear();
+      for (auto const &size : split(args[++i], ',')) {
+        options.message_sizes.push_back(std::stoul(size));
+      }
+    } else if (args[i] == "-r") {
+      options.rndv_thresholds = split(args[++i], ',');
+    } else if (args[i] == "-z") {
+      options.zcopy_thresholds = split(args[++i], ',');
+    } else if (args[i] == "-T") {
+      options.transports = split(args[++i], ';');
+    } else if (args[i] == "-b") {
+      options.bytes_per_size = std::stoul(args[++i]);
+    } else if (args[i] == "-n") {
+      options.max_iterations = std::stoul(args[++i]);
+    } else if (args[i] == "-o") {
+      options.window = std::stoul(args[++i]);
+    } else if (args[i] == "-f") {
+      options.output = args[++i];
+    } else {
+      ::fprintf(stderr, "unknown option: %s\n", args[i].c_str());
+      return 1;
+    }
+  }
+  if (options.message_sizes.empty() || options.rndv_thresholds.empty() ||
+      options.zcopy_thresholds.empty() || options.transports.empty() ||
+      options.window == 0) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  /* Every candidate is scored by its mean cost relative to the defaults */
+  auto baseline = run_candidate({"auto", "auto", ""}, options);
+  candidate best{"auto", "auto", ""};
+  double best_score = 1.0;
+  for (auto const &tls : options.transports) {
+    for (auto const &rndv : options.rndv_thresholds) {
+      for (auto const &zcopy : options.zcopy_thresholds) {
+        candidate c{rndv, zcopy, tls};
+        auto results = run_candidate(c, options);
+        double score = 0;
+        for (size_t i = 0; i < results.size(); ++i) {
+          score += results[i] / baseline[i];
+        }
+        score /= results.size();
+        ::fprintf(stdout, "TLS=%s RNDV_THRESH=%s ZCOPY_THRESH=%s score=%.3f\n",
+                  tls.empty() ? "(env)" : tls.c_str(), rndv.c_str(),
+                  zcopy.c_str(), score);
+        for (size_t i = 0; i < results.size(); ++i) {
+          ::fprintf(stdout, "  %zu bytes: %.1fns/msg\n",
+                    options.message_sizes[i], results[i]);
+        }
+        if (score < best_score) {
+          best_score = score;
+          best = c;
+        }
+      }
+    }
+  }
+
+  write_profile(options.output, best, options, best_score);
+  ::fprintf(stdout,
+            "Best: TLS=%s RNDV_THRESH=%s ZCOPY_THRESH=%s score=%.3f\n"
+            "Profile written to %s\n",
+            best.transports.empty() ? "(env)" : best.transports.c_str(),
+            best.rndv_thresh.c_str(), best.zcopy_thresh.c_str(), best_score,
+            options.output.c_str());
+  return 0;
+}
@@ -0,0 +1,252 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <ucxpp/ucxpp.h>
+
+constexpr ucp_tag_t k_scale_tag = 0x5CA1E;
+
+struct scale_options {
+  std::vector<size_t> counts = {1, 10, 100, 1000, 10000};
+  size_t messages = 1000000;
+  size_t message_size = 8;
+  size_t window = 16;
+  size_t idle_progress = 100000;
+  std::string transports = "self,sm,tcp";
+  bool compact = false;
+};
+
+struct traffic {
+  size_t total;
+  size_t posted_sends = 0;
+  size_t posted_recvs = 0;
+  size_t received = 0;
+  size_t active = 0;
+};
+
+using clock_type = std::chrono::steady_clock;
+
+static size_t resident_bytes() {
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0, resident = 0;
+  statm >> size >> resident;
+  return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+static double ns_since(clock_type::time_point start) {
+  return std::chrono::duration<double, std::nano>(clock_type::now() - start)
+      .count();
+}
+
+template <class Endpoints>
+ucxpp::task<void> sender(Endpoints const &eps, void *buffer,
+                         size_t message_size, traffic &t) {
+  while (t.posted_sends < t.total) {
+    auto &ep = eps[t.posted_sends++ % eps.size()];
+    co_await ep->tag_send(buffer, message_size, k_scale_tag);
+  }
+  t.active--;
+}
+
+template <class Endpoint>
+ucxpp::task<void> send_one(Endpoint const &ep, void *buffer,
+                           size_t message_size) {
+  co_await ep->tag_send(buffer, message_size, k_scale_tag);
+}
+
+ucxpp::task<void> receiver(std::shared_ptr<ucxpp::worker> worker,
+                           void *buffer, size_t message_size, traffic &t) {
+  while (t.posted_recvs < t.total) {
+    t.posted_recvs++;
+    co_await worker->tag_recv(buffer, message_size, k_scale_tag);
+    t.received++;
+  }
+  t.active--;
+}
+
+ucxpp::task<void> close_all(std::shared_ptr<ucxpp::worker> worker,
+                            bool &closed) {
+  co_await worker->close_all();
+  closed = true;
+}
+
+template <class Endpoints, class Create>
+static void run_count(size_t count, scale_options const &options,
+                      Create &&create) {
+  auto ctx = ucxpp::context::builder()
+                 .enable_tag()
+                 .transports(options.transports)
+                 .estimated_num_eps(count)
+                 .build();
+  auto send_worker = std::make_shared<ucxpp::worker>(ctx);
+  auto recv_worker = std::make_shared<ucxpp::worker>(ctx);
+  auto address = recv_worker->get_address();
+  auto address_bytes = reinterpret_cast<char const *>(address.get_address());
+  auto peer = ucxpp::remote_address(std::vector<char>(
+      address_bytes, address_bytes + address.get_length()));
+
+  std::vector<ucxpp::local_memory_handle> mrs;
+  std::vector<void *> send_buffers, recv_buffers;
+  for (size_t i = 0; i < options.window; ++i) {
+    auto [send_buffer, send_mr] =
+        ucxpp::local_memory_handle::allocate_mem(ctx, options.message_size);
+    auto [recv_buffer, recv_mr] =
+        ucxpp::local_memory_handle::allocate_mem(ctx, options.message_size);
+    send_buffers.push_back(send_buffer);
+    recv_buffers.push_back(recv_buffer);
+    mrs.push_back(std::move(send_mr));
+    mrs.push_back(std::move(recv_mr));
+  }
+
+  /* Creation time and memory */
+  Endpoints eps;
+  eps.reserve(count);
+  auto rss_before = resident_bytes();
+  auto start = clock_type::now();
+  for (size_t i = 0; i < count; ++i) {
+    eps.push_back(create(send_worker, peer));
+  }
+  auto create_ns = ns_since(start) / count;
+  auto rss_per_ep = (static_cast<double>(resident_bytes()) -
+                     static_cast<double>(rss_before)) /
+                    count;
+
+  /* Time to first message, one endpoint at a time */
+  double first_ns = 0;
+  for (auto const &ep : eps) {
+    traffic t{1};
+    t.active = 1;
+    start = clock_type::now();
+    receiver(recv_worker, recv_buffers[0], options.message_size, t).detach();
+    send_one(ep, send_buffers[0], options.message_size).detach();
+    while (t.active > 0) {
+      send_worker->progress();
+      recv_worker->progress();
+    }
+    first_ns += ns_since(start);
+  }
+  first_ns /= count;
+
+  /* Idle progress cost */
+  start = clock_type::now();
+  for (size_t i = 0; i < options.idle_progress; ++i) {
+    send_worker->progress();
+  }
+  auto idle_ns = ns_since(start) / options.idle_progress;
+
+  /* Round-robin message rate */
+  traffic t{options.messages};
+  size_t progress_calls = 0;
+  start = clock_type::now();
+  for (size_t i = 0; i < options.window; ++i) {
+    t.active += 2;
+    receiver(recv_worker, recv_buffers[i], options.message_size, t).detach();
+    sender(eps, send_buffers[i], options.message_size, t).detach();
+  }
+  while (t.active > 0) {
+    send_worker->progress();
+    recv_worker->progress();
+    progress_calls++;
+  }
+  auto elapsed_ns = ns_since(start);
+  auto rate = options.messages / elapsed_ns * 1e9;
+  auto busy_ns = elapsed_ns / progress_calls / 2;
+
+  ::fprintf(stdout, "%zu,%.1f,%.1f,%.1f,%.1f,%.0f,%.1f\n", count, rss_per_ep,
+            create_ns / 1e3, first_ns / 1e3, idle_ns, rate, busy_ns);
+  ::fflush(stdout);
+
+  bool closed = false;
+  close_all(send_worker, closed).detach();
+  while (!closed) {
+    send_worker->progress();
+    recv_worker->progress();
+  }
+}
+
+void print_usage(char const *argv0) {
+  ::fprintf(stderr,
+            "Usage: %s [options]\n"
+            "-c\tComma-separated endpoint counts (default: "
+            "1,10,100,1000,10000)\n"
+            "-n\tMessages in the round-robin phase (default: 1000000)\n"
+            "-s\tMessage size (default: 8)\n"
+            "-o\tConcurrent requests (default: 16)\n"
+            "-T\tUCX transports (default: self,sm,tcp)\n"
+            "-C\tUse compact endpoints from an endpoint pool\n",
+            argv0);
+}
+
+int main(int argc, char *argv[]) {
+  auto args = std::vector<std::string>(argv + 1, argv + argc);
+  scale_options options;
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "-h") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (args[i] == "-C") {
+      options.compact = true;
+    } else if (i + 1 >= args.size()) {
+      ::fprintf(stderr, "missing value for option: %s\n", args[i].c_str());
+      return 1;
+    } else if (args[i] == "-c") {
+      options.counts.clear();
+      size_t pos = 0;
+      auto const &list = args[++i];
+      while (pos < list.size()) {
+        size_t used;
+        options.counts.push_back(std::stoul(list.substr(pos), &used));
+        pos += used + 1;
+      }
+    } else if (args[i] == "-n") {
+      options.messages = std::stoul(args[++i]);
+    } else if (args[i] == "-s") {
+      options.message_size = std::stoul(args[++i]);
+    } else if (args[i] == "-o") {
+      options.window = std::stoul(args[++i]);
+    } else if (args[i] == "-T") {
+      options.transports = args[++i];
+    } else {
+      ::fprintf(stderr, "unknown option: %s\n", args[i].c_str());
+      return 1;
+    }
+  }
+  if (options.window == 0 || options.messages == 0) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  /* RSS covers both workers, since the peer lives in this process */
+  ::fprintf(stdout, "endpoints,rss_bytes_per_ep,create_us_per_ep,"
+                    "first_msg_us,idle_progress_ns,msg_rate,"
+                    "busy_progress_ns\n");
+  for (auto count : options.counts) {
+    if (count == 0) {
+      continue;
+    }
+    if (options.compact) {
+      std::unique_ptr<ucxpp::endpoint_pool> pool;
+      run_count<std::vector<ucxpp::endpoint_pool::pointer>>(
+          count, options,
+          [&](std::shared_ptr<ucxpp::worker> worker,
+              ucxpp::remote_address const &peer) {
+            if (!pool) {
+              pool = std::make_unique<ucxpp::endpoint_pool>(worker);
+            }
+            return pool->create(peer);
+          });
+    } else {
+      run_count<std::vector<std::shared_ptr<ucxpp::endpoint>>>(
+          count, options,
+          [](std::shared_ptr<ucxpp::worker> worker,
+             ucxpp::remote_address const &peer) {
+            return std::make_shared<ucxpp::endpoint>(worker, peer);
+          });
+    }
+  }
+  return 0;
+}
@@ -3,7 +3,6 @@
 #include "socket/channel.h"
 #include "worker_epoll.h"
 #include <algorithm>
-#include <endian.h>
 #include <iomanip>
 #include <iostream>
 #include <memory>
@@ -11,30 +10,21 @@
 #include "ucxpp/context.h"
 #include "ucxpp/endpoint.h"
 #include "ucxpp/memory.h"
+#include "ucxpp/detail/serdes.h"
 #include <ucxpp/ucxpp.h>
 
 constexpr ucp_tag_t kTestTag = 0xFD709394UL;
 constexpr ucp_tag_t kBellTag = 0xbe11be11UL;
 
+/* The remote address and the packed rkey arrive as two frames */
 ucxpp::task<std::pair<uint64_t, ucxpp::remote_memory_handle>>
 receive_mr(std::shared_ptr<ucxpp::endpoint> ep) {
-  using std::cout;
-  using std::endl;
-  uint64_t remote_addr;
-  co_await ep->stream_recv(&remote_addr, sizeof(remote_addr));
-  remote_addr = ::be64toh(remote_addr);
-  size_t rkey_length;
-  co_await ep->stream_recv(&rkey_length, sizeof(rkey_length));
-  rkey_length = ::be64toh(rkey_length);
-  std::vector<char> rkey_buffer(rkey_length);
-  size_t rkey_recved = 0;
-  while (rkey_recved < rkey_length) {
-    auto n = co_await ep->stream_recv(&rkey_buffer[rkey_recved],
-                                      rkey_length - rkey_recved);
-    rkey_recved += n;
-  }
+  ucxpp::stream_reader reader(ep, 1024);
+  auto address_frame = co_await reader.read_frame();
+  auto remote_addr = ucxpp::detail::load<uint64_t>(address_frame.data());
+  auto rkey_frame = co_await reader.read_frame();
   co_return std::make_pair(remote_addr,
-                           ucxpp::remote_memory_handle(ep, rkey_buffer.data()));
+                           ucxpp::remote_memory_handle(ep, rkey_frame.data()));
 }
 
 ucxpp::task<void> client(ucxpp::connector connector) {
@@ -127,11 +117,12 @@ ucxpp::task<void> client(ucxpp::connector connector) {
 ucxpp::task<void> send_mr(std::shared_ptr<ucxpp::endpoint> ep, void *address,
                           ucxpp::local_memory_handle const &local_mr) {
   auto packed_rkey = local_mr.pack_rkey();
-  auto rkey_length = ::htobe64(packed_rkey.get_length());
-  auto remote_addr = ::htobe64(reinterpret_cast<uint64_t>(address));
-  co_await ep->stream_send(&remote_addr, sizeof(remote_addr));
-  co_await ep->stream_send(&rkey_length, sizeof(rkey_length));
-  co_await ep->stream_send(packed_rkey.get_buffer(), packed_rkey.get_length());
+  char remote_addr[sizeof(uint64_t)];
+  ucxpp::detail::store(remote_addr, reinterpret_cast<uint64_t>(address));
+  ucxpp::stream_writer writer(ep, 1024);
+  co_await writer.write(remote_addr, sizeof(remote_addr));
+  co_await writer.write(packed_rkey.get_buffer(), packed_rkey.get_length());
+  co_await writer.flush();
   co_return;
 }
 
@@ -0,0 +1,265 @@
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <memory>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include <ucxpp/ucxpp.h>
+
+constexpr ucp_tag_t k_bench_tag = 0x0B7E57;
+
+struct bench_options {
+  size_t iterations = 1000000;
+  size_t message_size = 8;
+  std::string transports = "self,sm,tcp";
+};
+
+struct bench_run {
+  size_t total;
+  size_t sent = 0;
+  size_t received = 0;
+  size_t active = 0;
+  uint64_t instructions = 0;
+};
+
+/* Counts user-space instructions of the calling thread */
+class instruction_counter {
+  int fd_;
+
+public:
+  instruction_counter() {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  bool valid() const { return fd_ >= 0; }
+
+  uint64_t read() const {
+    uint64_t value = 0;
+    if (fd_ >= 0 && ::read(fd_, &value, sizeof(value)) != sizeof(value)) {
+      value = 0;
+    }
+    return value;
+  }
+
+  ~instruction_counter() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+};
+
+/*
+ * Builds its request parameters with run-time branches on the datatype, the
+ * memory handle and the flags, the way every send did before op_policy.
+ */
+class runtime_tag_send : public ucxpp::send_awaitable<runtime_tag_send> {
+  ucp_ep_h ep_;
+  ucp_tag_t tag_;
+  void const *buffer_;
+  size_t length_;
+  ucp_datatype_t datatype_;
+  ucp_mem_h memh_;
+  uint32_t flags_;
+  friend class send_awaitable;
+
+public:
+  runtime_tag_send(ucp_ep_h ep, void const *buffer, size_t length,
+                   ucp_tag_t tag)
+      : ep_(ep), tag_(tag), buffer_(buffer), length_(length),
+        datatype_(ucp_dt_make_contig(1)), memh_(nullptr),
+        flags_(UCP_OP_ATTR_FLAG_MULTI_SEND) {}
+
+  bool await_ready() noexcept {
+    ucp_request_param_t send_param;
+    send_param.op_attr_mask =
+        UCP_OP_ATTR_FIELD_CALLBACK | UCP_OP_ATTR_FIELD_USER_DATA | flags_;
+    send_param.cb.send = &ucxpp::detail::send_cb<runtime_tag_send>;
+    send_param.user_data = this;
+    if (datatype_ != ucp_dt_make_contig(1)) {
+      send_param.op_attr_mask |= UCP_OP_ATTR_FIELD_DATATYPE;
+      send_param.datatype = datatype_;
+    }
+    if (memh_ != nullptr) {
+      send_param.op_attr_mask |= UCP_OP_ATTR_FIELD_MEMH;
+      send_param.memh = memh_;
+    }
+    auto request = ::ucp_tag_send_nbx(ep_, buffer_, length_, tag_, &send_param);
+    return check_request_ready(request);
+  }
+};
+
+/* Awaits an operation whose await_ready() has already been called */
+template <class Awaitable> class issued_awaitable {
+  Awaitable &op_;
+  bool ready_;
+
+public:
+  issued_awaitable(Awaitable &op, bool ready) : op_(op), ready_(ready) {}
+  bool await_ready() const noexcept { return ready_; }
+  bool await_suspend(std::coroutine_handle<> h) {
+    return op_.await_suspend(h);
+  }
+  void await_resume() { op_.await_resume(); }
+};
+
+/* Only the issuing call of each operation is counted */
+template <class Issue>
+ucxpp::task<void> sender(instruction_counter const &counter, Issue issue,
+                         bench_run &run) {
+  while (run.sent < run.total) {
+    auto op = issue();
+    auto before = counter.read();
+    auto ready = op.await_ready();
+    run.instructions += counter.read() - before;
+    run.sent++;
+    co_await issued_awaitable<decltype(op)>(op, ready);
+  }
+  run.active--;
+}
+
+ucxpp::task<void> receiver(std::shared_ptr<ucxpp::worker> worker,
+                           void *buffer, size_t message_size,
+                           bench_run &run) {
+  while (run.received < run.total) {
+    co_await worker->tag_recv(buffer, message_size, k_bench_tag);
+    run.received++;
+  }
+  run.active--;
+}
+
+ucxpp::task<void> close_all(std::shared_ptr<ucxpp::worker> worker,
+                            bool &closed) {
+  co_await worker->close_all();
+  closed = true;
+}
+
+template <class Issue>
+static void measure(char const *name, std::shared_ptr<ucxpp::worker> sender_w,
+                    std::shared_ptr<ucxpp::worker> receiver_w,
+                    instruction_counter const &counter, void *recv_buffer,
+                    bench_options const &options, Issue issue) {
+  /* The counter read itself is subtracted from every sample */
+  auto calibration = counter.read();
+  calibration = counter.read() - calibration;
+
+  bench_run run{options.iterations};
+  run.active = 2;
+  auto start = std::chrono::steady_clock::now();
+  receiver(receiver_w, recv_buffer, options.message_size, run).detach();
+  sender(counter, issue, run).detach();
+  while (run.active > 0) {
+    sender_w->progress();
+    receiver_w->progress();
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  auto instructions = static_cast<double>(run.instructions) / run.total;
+  ::fprintf(stdout, "%s,%zu,%.1f,%.1f\n", name, options.message_size,
+            counter.valid() ? instructions - calibration : 0.0,
+            elapsed.count() / run.total);
+}
+
+void print_usage(char const *argv0) {
+  ::fprintf(stderr,
+            "Usage: %s [options]\n"
+            "-n\tIterations per variant (default: 1000000)\n"
+            "-s\tMessage size (default: 8)\n"
+            "-T\tUCX transports (default: self,sm,tcp)\n",
+            argv0);
+}
+
+int main(int argc, char *argv[]) {
+  auto args = std::vector<std::string>(argv + 1, argv + argc);
+  bench_options options;
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "-h") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (i + 1 >= args.size()) {
+      ::fprintf(stderr, "missing value for option: %s\n", args[i].c_str());
+      return 1;
+    } else if (args[i] == "-n") {
+      options.iterations = std::stoul(args[++i]);
+    } else if (args[i] == "-s") {
+      options.message_size = std::stoul(args[++i]);
+    } else if (args[i] == "-T") {
+      options.transports = args[++i];
+    } else {
+      ::fprintf(stderr, "unknown option: %s\n", args[i].c_str());
+      return 1;
+    }
+  }
+  if (options.iterations == 0) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  auto ctx = ucxpp::context::builder()
+                 .enable_tag()
+                 .transports(options.transports)
+                 .build();
+  auto sender_worker = std::make_shared<ucxpp::worker>(ctx);
+  auto receiver_worker = std::make_shared<ucxpp::worker>(ctx);
+  auto address = receiver_worker->get_address();
+  auto address_bytes = reinterpret_cast<char const *>(address.get_address());
+  auto peer = ucxpp::remote_address(std::vector<char>(
+      address_bytes, address_bytes + address.get_length()));
+  auto ep = std::make_shared<ucxpp::endpoint>(sender_worker, peer);
+
+  auto [send_buffer, send_mr] =
+      ucxpp::local_memory_handle::allocate_mem(ctx, options.message_size);
+  auto [recv_buffer, recv_mr] =
+      ucxpp::local_memory_handle::allocate_mem(ctx, options.message_size);
+  auto size = options.message_size;
+  auto memh = send_mr.handle();
+
+  instruction_counter counter;
+  if (!counter.valid()) {
+    ::perror("perf_event_open, instructions are not counted");
+  }
+
+  using fast_policy = ucxpp::op_policy<UCP_OP_ATTR_FLAG_MULTI_SEND |
+                                       UCP_OP_ATTR_FLAG_FAST_CMPL>;
+  using memh_policy =
+      ucxpp::op_policy<UCP_OP_ATTR_FLAG_MULTI_SEND, false, true>;
+
+  ::fprintf(stdout, "variant,size,instructions_per_issue,ns_per_op\n");
+  measure("runtime", sender_worker, receiver_worker, counter, recv_buffer,
+          options, [&, buffer = send_buffer] {
+            return runtime_tag_send(ep->handle(), buffer, size, k_bench_tag);
+          });
+  measure("default", sender_worker, receiver_worker, counter, recv_buffer,
+          options, [&, buffer = send_buffer] {
+            return ep->tag_send(buffer, size, k_bench_tag);
+          });
+  measure("fast_cmpl", sender_worker, receiver_worker, counter, recv_buffer,
+          options, [&, buffer = send_buffer] {
+            return ep->tag_send<fast_policy>(buffer, size, k_bench_tag);
+          });
+  measure("memh", sender_worker, receiver_worker, counter, recv_buffer,
+          options, [&, buffer = send_buffer] {
+            return ep->tag_send<memh_policy>(buffer, size, k_bench_tag,
+                                             memh);
+          });
+
+  bool closed = false;
+  close_all(sender_worker, closed).detach();
+  while (!closed) {
+    sender_worker->progress();
+    receiver_worker->progress();
+  }
+  return 0;
+}
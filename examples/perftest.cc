@@ -40,6 +40,13 @@ struct perf_context {
   std::string server_address;
   uint16_t server_port = 8888;
   std::optional<size_t> core;
+  std::string profile;
+  bool adaptive = false;
+  size_t target_latency_us = 0;
+  bool pipelined = false;
+  bool prepared = false;
+  size_t completion_budget = 0;
+  bool startup_stats = false;
 };
 
 constexpr ucp_tag_t k_test_tag = 0xFD709394;
@@ -102,17 +109,29 @@ static void bind_cpu(int core) {
 
 ucxpp::task<void> sender(std::shared_ptr<ucxpp::endpoint> ep,
                          size_t &iterations, bool warmup,
-                         perf_context const &perf) {
+                         perf_context const &perf,
+                         ucxpp::window_controller *window) {
   auto [buffer, local_mr] = ucxpp::local_memory_handle::allocate_mem(
       ep->worker_ptr()->context_ptr(), perf.message_size);
   auto total_iterations = warmup ? perf.warmup_iterations : perf.iterations;
   while (iterations < total_iterations) {
     switch (perf.test.first) {
     case test_category::stream: {
-      co_await ep->stream_send(buffer, perf.message_size);
+      if (window != nullptr) {
+        co_await window->run(ep->stream_send(buffer, perf.message_size),
+                             perf.message_size);
+      } else {
+        co_await ep->stream_send(buffer, perf.message_size);
+      }
     } break;
     default: {
-      co_await ep->tag_send(buffer, perf.message_size, k_test_tag);
+      if (window != nullptr) {
+        co_await window->run(
+            ep->tag_send(buffer, perf.message_size, k_test_tag),
+            perf.message_size);
+      } else {
+        co_await ep->tag_send(buffer, perf.message_size, k_test_tag);
+      }
     } break;
     }
     iterations++;
@@ -120,16 +139,94 @@ ucxpp::task<void> sender(std::shared_ptr<ucxpp::endpoint> ep,
   }
 }
 
+/* With -R, each sender prepares its operation once and restarts it */
+ucxpp::task<void> prepared_sender(std::shared_ptr<ucxpp::endpoint> ep,
+                                  size_t &iterations, bool warmup,
+                                  perf_context const &perf) {
+  auto [buffer, local_mr] = ucxpp::local_memory_handle::allocate_mem(
+      ep->worker_ptr()->context_ptr(), perf.message_size);
+  auto total_iterations = warmup ? perf.warmup_iterations : perf.iterations;
+  switch (perf.test.first) {
+  case test_category::stream: {
+    auto op = ep->prepare_stream_send(buffer, perf.message_size,
+                                      local_mr.handle());
+    while (iterations < total_iterations) {
+      op.start();
+      co_await op;
+      iterations++;
+      print_report(perf);
+    }
+  } break;
+  default: {
+    auto op = ep->prepare_tag_send(buffer, perf.message_size, k_test_tag,
+                                   local_mr.handle());
+    while (iterations < total_iterations) {
+      op.start();
+      co_await op;
+      iterations++;
+      print_report(perf);
+    }
+  } break;
+  }
+}
+
+/* With -W, one coroutine keeps -o requests in flight */
+ucxpp::task<void> pipelined_sender(std::shared_ptr<ucxpp::endpoint> ep,
+                                   size_t &iterations, bool warmup,
+                                   perf_context const &perf) {
+  auto [buffer, local_mr] = ucxpp::local_memory_handle::allocate_mem(
+      ep->worker_ptr()->context_ptr(), perf.message_size);
+  auto total_iterations = warmup ? perf.warmup_iterations : perf.iterations;
+  switch (perf.test.first) {
+  case test_category::stream: {
+    ucxpp::pipeline<ucxpp::stream_send_awaitable> pipeline(perf.concurrency);
+    while (iterations < total_iterations) {
+      co_await pipeline.submit(ep->stream_send(buffer, perf.message_size));
+      iterations++;
+      print_report(perf);
+    }
+    co_await pipeline.drain();
+  } break;
+  default: {
+    ucxpp::pipeline<ucxpp::tag_send_awaitable> pipeline(perf.concurrency);
+    while (iterations < total_iterations) {
+      co_await pipeline.submit(
+          ep->tag_send(buffer, perf.message_size, k_test_tag));
+      iterations++;
+      print_report(perf);
+    }
+    co_await pipeline.drain();
+  } break;
+  }
+}
+
 ucxpp::task<void> client(ucxpp::connector connector, perf_context const &perf) {
   auto ep = co_await connector.connect();
   ep->print();
   g_connected = true;
 
+  /* With -A, -o is the largest window and the controller picks the depth */
+  std::unique_ptr<ucxpp::window_controller> window;
+  if (perf.adaptive) {
+    ucxpp::window_options options;
+    options.max = perf.concurrency;
+    options.target_latency =
+        std::chrono::microseconds(perf.target_latency_us);
+    window = std::make_unique<ucxpp::window_controller>(*ep->worker_ptr(),
+                                                        options);
+  }
+
   ::fprintf(stderr, "Warming up...\n");
-  {
+  if (perf.pipelined) {
+    co_await pipelined_sender(ep, g_counter, true, perf);
+  } else {
     auto tasks = std::vector<ucxpp::task<void>>();
     for (size_t i = 0; i < perf.concurrency; ++i) {
-      tasks.emplace_back(sender(ep, g_counter, true, perf));
+      if (perf.prepared) {
+        tasks.emplace_back(prepared_sender(ep, g_counter, true, perf));
+      } else {
+        tasks.emplace_back(sender(ep, g_counter, true, perf, window.get()));
+      }
     }
     for (auto &task : tasks) {
       co_await task;
@@ -139,16 +236,26 @@ ucxpp::task<void> client(ucxpp::connector connector, perf_context const &perf) {
   reset_report();
   g_start = std::chrono::steady_clock::now();
   ::fprintf(stderr, "Running...\n");
-  {
+  if (perf.pipelined) {
+    co_await pipelined_sender(ep, g_counter, false, perf);
+  } else {
     auto tasks = std::vector<ucxpp::task<void>>();
     for (size_t i = 0; i < perf.concurrency; ++i) {
-      tasks.emplace_back(sender(ep, g_counter, false, perf));
+      if (perf.prepared) {
+        tasks.emplace_back(prepared_sender(ep, g_counter, false, perf));
+      } else {
+        tasks.emplace_back(sender(ep, g_counter, false, perf, window.get()));
+      }
     }
     for (auto &task : tasks) {
       co_await task;
     }
   }
   print_report(perf, true);
+  if (window) {
+    ::fprintf(stdout, "Final window: %zu, smoothed latency: %ldns\n",
+              window->window(), window->smoothed_latency().count());
+  }
 
   co_await ep->flush();
   co_await ep->close();
@@ -230,7 +337,14 @@ void print_usage(char const *argv0) {
             "-s\tSpecifies message size (default: 8)\n"
             "-w\tSpecifies number of warmup iterations (default: 10000)\n"
             "-e\tUse epoll for worker progress (default: false)\n"
-            "-p\tServer port (default 8888)\n",
+            "-p\tServer port (default 8888)\n"
+            "-P\tStartup profile (local-only, tcp, network)\n"
+            "-A\tAdapt the in-flight window up to -o requests\n"
+            "-L\tTarget latency in us for -A (default: bandwidth plateau)\n"
+            "-W\tKeep -o requests in flight from a single coroutine\n"
+            "-R\tPrepare each sender's operation once and restart it\n"
+            "-Q\tQueue completions, resuming at most N per progress call\n"
+            "-V\tPrint context startup statistics\n",
             argv0);
 }
 
@@ -265,6 +379,20 @@ int main(int argc, char *argv[]) {
       perf.epoll = true;
     } else if (args[i] == "-p") {
       perf.server_port = std::stoul(args[++i]);
+    } else if (args[i] == "-P") {
+      perf.profile = args[++i];
+    } else if (args[i] == "-A") {
+      perf.adaptive = true;
+    } else if (args[i] == "-L") {
+      perf.target_latency_us = std::stoul(args[++i]);
+    } else if (args[i] == "-W") {
+      perf.pipelined = true;
+    } else if (args[i] == "-R") {
+      perf.prepared = true;
+    } else if (args[i] == "-Q") {
+      perf.completion_budget = std::stoul(args[++i]);
+    } else if (args[i] == "-V") {
+      perf.startup_stats = true;
     } else if (args[i][0] == '-') {
       ::fprintf(stderr, "unknown option: %s\n", args[i].c_str());
       return 1;
@@ -282,10 +410,20 @@ int main(int argc, char *argv[]) {
     if (perf.epoll) {
       builder.enable_wakeup();
     }
+    if (!perf.profile.empty()) {
+      builder.use_profile(perf.profile);
+    }
+    if (perf.startup_stats) {
+      builder.enable_print_startup_stats();
+    }
     return builder.build();
   }();
   auto loop = ucxpp::socket::event_loop::new_loop();
   auto worker = [&]() { return std::make_shared<ucxpp::worker>(ctx); }();
+  if (perf.completion_budget > 0) {
+    worker->set_completion_mode(ucxpp::completion_mode::queued,
+                                perf.completion_budget);
+  }
   if (perf.core.has_value()) {
     bind_cpu(perf.core.value());
   } else {
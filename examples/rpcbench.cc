@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ucxpp/ucxpp.h>
+
+constexpr uint32_t k_echo_method = 1;
+
+struct bench_options {
+  size_t calls = 100000;
+  size_t payload_size = 64;
+  size_t concurrency = 16;
+  size_t zcopy_threshold = 8192;
+  std::string transports = "self,sm,tcp";
+};
+
+using clock_type = std::chrono::steady_clock;
+
+ucxpp::task<ucxpp::rpc_payload> echo(ucxpp::rpc_payload args) {
+  co_return args;
+}
+
+ucxpp::task<void> caller(ucxpp::rpc_client &client, ucxpp::endpoint &ep,
+                         std::vector<char> const &args, size_t &issued,
+                         size_t total, std::vector<double> &latencies,
+                         size_t &active) {
+  while (issued < total) {
+    issued++;
+    auto start = clock_type::now();
+    auto reply =
+        co_await client.call(ep, k_echo_method, args.data(), args.size());
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(clock_type::now() - start)
+            .count());
+    if (reply.size() != args.size()) {
+      ::fprintf(stderr, "unexpected reply size: %zu\n", reply.size());
+    }
+  }
+  active--;
+}
+
+ucxpp::task<void> close_all(std::shared_ptr<ucxpp::worker> worker,
+                            bool &closed) {
+  co_await worker->close_all();
+  closed = true;
+}
+
+static double percentile(std::vector<double> const &sorted, double p) {
+  auto index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void print_usage(char const *argv0) {
+  ::fprintf(stderr,
+            "Usage: %s [options]\n"
+            "-n\tNumber of calls (default: 100000)\n"
+            "-s\tPayload size (default: 64)\n"
+            "-o\tConcurrent calls (default: 16)\n"
+            "-z\tZero-copy threshold (default: 8192)\n"
+            "-T\tUCX transports (default: self,sm,tcp)\n",
+            argv0);
+}
+
+int main(int argc, char *argv[]) {
+  auto args = std::vector<std::string>(argv + 1, argv + argc);
+  bench_options options;
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "-h") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (i + 1 >= args.size()) {
+      ::fprintf(stderr, "missing value for option: %s\n", args[i].c_str());
+      return 1;
+    } else if (args[i] == "-n") {
+      options.calls = std::stoul(args[++i]);
+    } else if (args[i] == "-s") {
+      options.payload_size = std::stoul(args[++i]);
+    } else if (args[i] == "-o") {
+      options.concurrency = std::stoul(args[++i]);
+    } else if (args[i] == "-z") {
+      options.zcopy_threshold = std::stoul(args[++i]);
+    } else if (args[i] == "-T") {
+      options.transports = args[++i];
+    } else {
+      ::fprintf(stderr, "unknown option: %s\n", args[i].c_str());
+      return 1;
+    }
+  }
+  if (options.concurrency == 0 || options.calls == 0) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  auto ctx = ucxpp::context::builder()
+                 .enable_am()
+                 .transports(options.transports)
+                 .build();
+  auto client_worker = std::make_shared<ucxpp::worker>(ctx);
+  auto server_worker = std::make_shared<ucxpp::worker>(ctx);
+  auto address = server_worker->get_address();
+  auto address_bytes = reinterpret_cast<char const *>(address.get_address());
+  auto peer = ucxpp::remote_address(std::vector<char>(
+      address_bytes, address_bytes + address.get_length()));
+
+  ucxpp::rpc_server server(server_worker, ucxpp::kRpcDefaultAmId,
+                           options.zcopy_threshold);
+  server.register_method(k_echo_method, echo);
+  ucxpp::rpc_client client(client_worker, ucxpp::kRpcDefaultAmId,
+                           options.zcopy_threshold);
+  auto ep = std::make_shared<ucxpp::endpoint>(client_worker, peer);
+
+  std::vector<char> payload(options.payload_size, 'x');
+  std::vector<double> latencies;
+  latencies.reserve(options.calls);
+  size_t issued = 0;
+  size_t active = options.concurrency;
+  auto start = clock_type::now();
+  for (size_t i = 0; i < options.concurrency; ++i) {
+    caller(client, *ep, payload, issued, options.calls, latencies, active)
+        .detach();
+  }
+  while (active > 0) {
+    client_worker->progress();
+    server_worker->progress();
+  }
+  auto elapsed =
+      std::chrono::duration<double>(clock_type::now() - start).count();
+
+  std::sort(latencies.begin(), latencies.end());
+  ::fprintf(stdout, "calls,payload,concurrency,calls_per_sec,p50_us,p90_us,"
+                    "p99_us,p999_us,max_us\n");
+  ::fprintf(stdout, "%zu,%zu,%zu,%.0f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+            latencies.size(), options.payload_size, options.concurrency,
+            latencies.size() / elapsed, percentile(latencies, 50),
+            percentile(latencies, 90), percentile(latencies, 99),
+            percentile(latencies, 99.9), latencies.back());
+
+  bool closed = false;
+  close_all(client_worker, closed).detach();
+  while (!closed) {
+    client_worker->progress();
+    server_worker->progress();
+  }
+  return 0;
+}
@@ -55,6 +55,21 @@ public:
    */
   std::vector<char> serialize() const;
 
+  /**
+   * @brief Get the size of the serialized address
+   *
+   * @return size_t The serialized size
+   */
+  size_t serialized_size() const;
+
+  /**
+   * @brief Serialize the address in place, e.g. into a registered send buffer
+   *
+   * @param buffer The destination of at least serialized_size() bytes
+   * @return size_t The number of bytes written
+   */
+  size_t serialize(void *buffer) const;
+
   /**
    * @brief Get the UCP address
    *
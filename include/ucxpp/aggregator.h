@@ -0,0 +1,217 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/endpoint.h"
+#include "ucxpp/generator.h"
+#include "ucxpp/memory.h"
+#include "ucxpp/recv_pool.h"
+#include "ucxpp/task.h"
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/waiter_queue.h"
+
+namespace ucxpp {
+
+/**
+ * @brief Packs small messages to one endpoint into registered batch buffers
+ * and sends each batch as one tag message. Each message is prefixed with its
+ * length as a 32-bit integer in network byte order. A batch is sent when it
+ * reaches the size threshold, when poll() finds it older than the time
+ * threshold, or on flush().
+ *
+ */
+class tag_aggregator : public noncopyable {
+  struct batch {
+    char *buffer;
+    size_t used;
+    bool in_flight;
+  };
+
+  /* Resumed by the worker after a batch send completes */
+  class idle_awaitable : public detail::waiter {
+    tag_aggregator *aggregator_;
+
+  public:
+    idle_awaitable(tag_aggregator *aggregator) : aggregator_(aggregator) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const {}
+  };
+
+  std::shared_ptr<endpoint> endpoint_;
+  ucp_tag_t tag_;
+  size_t capacity_;
+  size_t threshold_;
+  std::chrono::steady_clock::duration max_delay_;
+  std::vector<local_memory_handle> mrs_;
+  std::vector<batch> batches_;
+  size_t current_;
+  std::chrono::steady_clock::time_point first_push_;
+  detail::waiter_queue waiters_;
+  std::exception_ptr error_;
+
+  batch *seal();
+  task<void> send_batch(batch *b);
+
+public:
+  /**
+   * @brief Length prefix of each message in a batch
+   *
+   */
+  using length_type = uint32_t;
+
+  /**
+   * @brief Construct a new tag aggregator object
+   *
+   * @param endpoint The endpoint to send batches to
+   * @param tag The tag of every batch
+   * @param capacity Size of each batch buffer. Receivers must post buffers of
+   * at least this size.
+   * @param threshold Batch size in bytes that triggers a send
+   * @param max_delay Age of the oldest message in a batch that triggers a send
+   * in poll()
+   * @param depth Number of batch buffers, bounding the batches in flight
+   */
+  tag_aggregator(std::shared_ptr<endpoint> endpoint, ucp_tag_t tag,
+                 size_t capacity = 8192, size_t threshold = 8192,
+                 std::chrono::steady_clock::duration max_delay =
+                     std::chrono::microseconds(50),
+                 size_t depth = 4);
+
+  /**
+   * @brief Append a message to the current batch. The message is copied.
+   *
+   * @param data The message
+   * @param length The length of the message
+   * @return true If the message was appended
+   * @return false If all batch buffers are in flight. The caller should
+   * progress the worker and retry, or use write().
+   */
+  bool push(void const *data, size_t length);
+
+  /**
+   * @brief Append a message, waiting for a free batch buffer if needed. The
+   * message is copied.
+   *
+   * @param data The message
+   * @param length The length of the message
+   * @return task<void> A coroutine that returns when the message is appended
+   */
+  task<void> write(void const *data, size_t length);
+
+  /**
+   * @brief Send the current batch if its oldest message is older than the
+   * time threshold
+   *
+   * @return true If a batch was sent
+   * @return false If no batch was sent
+   */
+  bool poll();
+
+  /**
+   * @brief Send the current batch and wait for all batches to be sent,
+   * including those sent earlier by push() and poll()
+   *
+   * @return task<void> A coroutine that returns when no batch is in flight
+   */
+  task<void> flush();
+
+  /**
+   * @brief Get the number of batches in flight
+   *
+   * @return size_t The number of batches in flight
+   */
+  size_t in_flight() const;
+
+  /**
+   * @brief Destroy the tag aggregator object. Unflushed messages are dropped
+   * and no batch may be in flight, as UCX sends from the batch buffers.
+   *
+   */
+  ~tag_aggregator();
+};
+
+/**
+ * @brief A received batch of messages sent by a tag_aggregator. It does not
+ * copy the buffer. Iteration stops at the first record whose length prefix
+ * runs past the end of the buffer.
+ *
+ */
+class tag_batch {
+  char const *begin_;
+  char const *end_;
+
+public:
+  /**
+   * @brief A message in a batch
+   *
+   */
+  struct message {
+    void const *data;
+    size_t length;
+  };
+
+  class iterator {
+    char const *pos_;
+    char const *end_;
+
+    /* Moves to the end if the record at pos_ does not fit */
+    void check();
+
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = message;
+    using difference_type = std::ptrdiff_t;
+    using pointer = message const *;
+    using reference = message;
+
+    iterator(char const *pos, char const *end) : pos_(pos), end_(end) {
+      check();
+    }
+    message operator*() const;
+    iterator &operator++();
+    iterator operator++(int);
+    bool operator==(iterator const &other) const { return pos_ == other.pos_; }
+    bool operator!=(iterator const &other) const { return pos_ != other.pos_; }
+  };
+
+  /**
+   * @brief Construct a new tag batch object
+   *
+   * @param buffer The receive buffer
+   * @param length The number of bytes received
+   */
+  tag_batch(void const *buffer, size_t length);
+
+  iterator begin() const;
+  iterator end() const;
+
+  /**
+   * @brief Check that the records fill the buffer exactly
+   *
+   * @return true If the batch is well formed
+   * @return false If it is truncated or a length prefix is corrupt
+   */
+  bool valid() const;
+};
+
+/**
+ * @brief Yield the messages of batches received by a pool, in order. Each
+ * message stays valid until the next one is pulled.
+ *
+ * @param pool The pool receiving the batches
+ * @return async_generator<tag_batch::message> A generator of messages
+ */
+async_generator<tag_batch::message> unbatch(tag_recv_pool &pool);
+
+} // namespace ucxpp
\ No newline at end of file
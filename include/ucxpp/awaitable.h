@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <coroutine>
 #include <cstddef>
 #include <cstdint>
@@ -10,20 +11,56 @@
 #include <thread>
 #include <type_traits>
 #include <ucs/type/status.h>
+#include <vector>
 
 #include <ucp/api/ucp.h>
 
+#include "ucxpp/completion.h"
 #include "ucxpp/error.h"
 
 #include "ucxpp/detail/debug.h"
+#include "ucxpp/detail/policy_field.h"
+#include "ucxpp/detail/resume.h"
 
 namespace ucxpp {
 
+class endpoint_base;
 class base_awaitable {
+  friend class endpoint_base;
+
 protected:
   std::coroutine_handle<> h_;
   ucs_status_t status_;
-  base_awaitable() : h_(nullptr), status_(UCS_OK) {}
+  /* Set when the owning endpoint tracks in-flight operations */
+  endpoint_base const *owner_;
+  base_awaitable *prev_;
+  base_awaitable *next_;
+  base_awaitable() : h_(nullptr), status_(UCS_OK), owner_(nullptr) {}
+
+  void link_owner();
+  void unlink_owner();
+
+  void suspend(std::coroutine_handle<> h) {
+    h_ = h;
+    if (owner_ != nullptr) [[unlikely]] {
+      link_owner();
+    }
+  }
+
+  /* The status is kept if the owning endpoint has already failed us */
+  void complete(ucs_status_t status) {
+    if (owner_ != nullptr) [[unlikely]] {
+      unlink_owner();
+    }
+    if (status_ == UCS_INPROGRESS) [[likely]] {
+      status_ = status;
+    }
+    detail::resume(h_);
+  }
+
+  /* Set by an endpoint that is closed or failed, so nothing is issued */
+  bool rejected() const { return status_ != UCS_OK; }
+
   bool check_request_ready(ucs_status_ptr_t request) {
     if (UCS_PTR_IS_PTR(request)) [[unlikely]] {
       status_ = UCS_INPROGRESS;
@@ -40,124 +77,220 @@ protected:
 };
 
 /* Common awaitable class for send-like callbacks */
-template <class Derived> class send_awaitable : public base_awaitable {
-public:
-  static void send_cb(void *request, ucs_status_t status, void *user_data) {
-    auto self = reinterpret_cast<Derived *>(user_data);
-    self->status_ = status;
-    ::ucp_request_free(request);
-    self->h_.resume();
+template <class Derived, class Policy = default_op_policy>
+class send_awaitable : public base_awaitable {
+  [[no_unique_address]] detail::policy_field<Policy::kDatatype, ucp_datatype_t>
+      datatype_;
+  [[no_unique_address]] detail::policy_field<Policy::kMemh, ucp_mem_h> memh_;
+
+protected:
+  /* The datatype and memory handle are dropped unless the policy has them */
+  send_awaitable(ucp_datatype_t datatype = ucp_dt_make_contig(1),
+                 ucp_mem_h memh = nullptr)
+      : datatype_(datatype), memh_(memh) {
+    if constexpr (!Policy::kDatatype) {
+      assert(datatype == ucp_dt_make_contig(1));
+    }
+    if constexpr (!Policy::kMemh) {
+      assert(memh == nullptr);
+    }
   }
 
+  ucp_datatype_t datatype() const {
+    if constexpr (Policy::kDatatype) {
+      return datatype_.value;
+    } else {
+      return ucp_dt_make_contig(1);
+    }
+  }
+
+  ucp_mem_h memh() const {
+    if constexpr (Policy::kMemh) {
+      return memh_.value;
+    } else {
+      return nullptr;
+    }
+  }
+
+  Derived &derived() { return static_cast<Derived &>(*this); }
+
+public:
+  using policy_type = Policy;
+
+  /* Called through the completion layer when the request completes */
+  void on_complete(ucs_status_t status) { complete(status); }
+
   ucp_request_param_t build_param() {
-    ucp_request_param_t send_param;
-    send_param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
-                              UCP_OP_ATTR_FIELD_USER_DATA |
-                              UCP_OP_ATTR_FLAG_MULTI_SEND;
-    send_param.cb.send = &send_cb;
-    send_param.user_data = this;
-    return send_param;
+    return detail::send_param<Policy>(derived(), datatype(), memh());
   }
 
   bool await_suspend(std::coroutine_handle<> h) {
-    h_ = h;
-    return status_ == UCS_INPROGRESS;
+    if (status_ != UCS_INPROGRESS) {
+      return false;
+    }
+    suspend(h);
+    return true;
   }
 
   void await_resume() const { check_ucs_status(status_, "operation failed"); }
 };
 
-class stream_send_awaitable : public send_awaitable<stream_send_awaitable> {
+template <class Policy = default_op_policy>
+class basic_stream_send_awaitable
+    : public send_awaitable<basic_stream_send_awaitable<Policy>, Policy> {
+  using base_type =
+      send_awaitable<basic_stream_send_awaitable<Policy>, Policy>;
   ucp_ep_h ep_;
   void const *buffer_;
   size_t length_;
-  friend class send_awaitable;
+  friend base_type;
 
 public:
-  stream_send_awaitable(ucp_ep_h ep, void const *buffer, size_t length)
-      : ep_(ep), buffer_(buffer), length_(length) {}
+  basic_stream_send_awaitable(ucp_ep_h ep, void const *buffer, size_t length,
+                              ucp_datatype_t datatype = ucp_dt_make_contig(1),
+                              ucp_mem_h memh = nullptr)
+      : base_type(datatype, memh), ep_(ep), buffer_(buffer), length_(length) {}
 
   bool await_ready() noexcept {
-    auto send_param = build_param();
-    auto request = ::ucp_stream_send_nbx(ep_, buffer_, length_, &send_param);
-    return check_request_ready(request);
+    if (this->rejected()) [[unlikely]] {
+      return true;
+    }
+    return this->check_request_ready(post_stream_send<Policy>(
+        ep_, buffer_, length_, *this, this->datatype(), this->memh()));
   }
 };
 
-class tag_send_awaitable : public send_awaitable<tag_send_awaitable> {
+using stream_send_awaitable = basic_stream_send_awaitable<>;
+
+template <class Policy = default_op_policy>
+class basic_tag_send_awaitable
+    : public send_awaitable<basic_tag_send_awaitable<Policy>, Policy> {
+  using base_type = send_awaitable<basic_tag_send_awaitable<Policy>, Policy>;
   ucp_ep_h ep_;
   ucp_tag_t tag_;
   void const *buffer_;
   size_t length_;
+  friend base_type;
+
+public:
+  basic_tag_send_awaitable(ucp_ep_h ep, void const *buffer, size_t length,
+                           ucp_tag_t tag,
+                           ucp_datatype_t datatype = ucp_dt_make_contig(1),
+                           ucp_mem_h memh = nullptr)
+      : base_type(datatype, memh), ep_(ep), tag_(tag), buffer_(buffer),
+        length_(length) {}
+
+  bool await_ready() noexcept {
+    if (this->rejected()) [[unlikely]] {
+      return true;
+    }
+    return this->check_request_ready(post_tag_send<Policy>(
+        ep_, buffer_, length_, tag_, *this, this->datatype(), this->memh()));
+  }
+};
+
+using tag_send_awaitable = basic_tag_send_awaitable<>;
+
+class am_send_awaitable : public send_awaitable<am_send_awaitable> {
+  ucp_ep_h ep_;
+  unsigned id_;
+  void const *header_;
+  size_t header_length_;
+  void const *buffer_;
+  size_t length_;
+  uint32_t flags_;
   friend class send_awaitable;
 
 public:
-  tag_send_awaitable(ucp_ep_h ep, void const *buffer, size_t length,
-                     ucp_tag_t tag)
-      : ep_(ep), tag_(tag), buffer_(buffer), length_(length) {}
+  am_send_awaitable(ucp_ep_h ep, unsigned id, void const *header,
+                    size_t header_length, void const *buffer, size_t length,
+                    uint32_t flags)
+      : ep_(ep), id_(id), header_(header), header_length_(header_length),
+        buffer_(buffer), length_(length), flags_(flags) {}
 
   bool await_ready() noexcept {
-    auto send_param = build_param();
-    auto request = ::ucp_tag_send_nbx(ep_, buffer_, length_, tag_, &send_param);
-    return check_request_ready(request);
+    if (rejected()) [[unlikely]] {
+      return true;
+    }
+    return check_request_ready(post_am_send(ep_, id_, header_, header_length_,
+                                            buffer_, length_, flags_, *this));
   }
 };
 
-class rma_put_awaitable : public send_awaitable<rma_put_awaitable> {
+template <class Policy = default_op_policy>
+class basic_rma_put_awaitable
+    : public send_awaitable<basic_rma_put_awaitable<Policy>, Policy> {
+  using base_type = send_awaitable<basic_rma_put_awaitable<Policy>, Policy>;
   ucp_ep_h ep_;
   void const *buffer_;
   size_t length_;
   uint64_t remote_addr_;
   ucp_rkey_h rkey_;
-  friend class send_awaitable;
+  friend base_type;
 
 public:
-  rma_put_awaitable(ucp_ep_h ep, void const *buffer, size_t length,
-                    uint64_t remote_addr, ucp_rkey_h rkey)
-      : ep_(ep), buffer_(buffer), length_(length), remote_addr_(remote_addr),
-        rkey_(rkey) {}
+  basic_rma_put_awaitable(ucp_ep_h ep, void const *buffer, size_t length,
+                          uint64_t remote_addr, ucp_rkey_h rkey,
+                          ucp_mem_h memh = nullptr)
+      : base_type(ucp_dt_make_contig(1), memh), ep_(ep), buffer_(buffer),
+        length_(length), remote_addr_(remote_addr), rkey_(rkey) {}
 
   bool await_ready() noexcept {
-    auto send_param = build_param();
-    auto request =
-        ::ucp_put_nbx(ep_, buffer_, length_, remote_addr_, rkey_, &send_param);
-    return check_request_ready(request);
+    if (this->rejected()) [[unlikely]] {
+      return true;
+    }
+    return this->check_request_ready(post_put<Policy>(
+        ep_, buffer_, length_, remote_addr_, rkey_, *this, this->memh()));
   }
 };
 
-class rma_get_awaitable : public send_awaitable<rma_get_awaitable> {
+using rma_put_awaitable = basic_rma_put_awaitable<>;
+
+template <class Policy = default_op_policy>
+class basic_rma_get_awaitable
+    : public send_awaitable<basic_rma_get_awaitable<Policy>, Policy> {
+  using base_type = send_awaitable<basic_rma_get_awaitable<Policy>, Policy>;
   ucp_ep_h ep_;
   void *buffer_;
   size_t length_;
   uint64_t remote_addr_;
   ucp_rkey_h rkey_;
-  friend class send_awaitable;
+  friend base_type;
 
 public:
-  rma_get_awaitable(ucp_ep_h ep, void *buffer, size_t length,
-                    uint64_t remote_addr, ucp_rkey_h rkey)
-      : ep_(ep), buffer_(buffer), length_(length), remote_addr_(remote_addr),
-        rkey_(rkey) {}
+  basic_rma_get_awaitable(ucp_ep_h ep, void *buffer, size_t length,
+                          uint64_t remote_addr, ucp_rkey_h rkey,
+                          ucp_mem_h memh = nullptr)
+      : base_type(ucp_dt_make_contig(1), memh), ep_(ep), buffer_(buffer),
+        length_(length), remote_addr_(remote_addr), rkey_(rkey) {}
 
   bool await_ready() noexcept {
-    auto send_param = build_param();
-    auto request =
-        ::ucp_get_nbx(ep_, buffer_, length_, remote_addr_, rkey_, &send_param);
-    return check_request_ready(request);
+    if (this->rejected()) [[unlikely]] {
+      return true;
+    }
+    return this->check_request_ready(post_get<Policy>(
+        ep_, buffer_, length_, remote_addr_, rkey_, *this, this->memh()));
   }
 };
 
-template <class T>
-class rma_atomic_awaitable : public send_awaitable<rma_atomic_awaitable<T>> {
+using rma_get_awaitable = basic_rma_get_awaitable<>;
+
+/* Fetching atomics pass a reply buffer, chosen at compile time by Fetch */
+template <class T, bool Fetch = false, class Policy = default_op_policy>
+class rma_atomic_awaitable
+    : public send_awaitable<rma_atomic_awaitable<T, Fetch, Policy>, Policy> {
   static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Only 4-byte and 8-byte "
                                                   "integers are supported");
+  static_assert(!Policy::kDatatype, "The datatype is implied by T");
+  using base_type =
+      send_awaitable<rma_atomic_awaitable<T, Fetch, Policy>, Policy>;
   ucp_ep_h ep_;
   ucp_atomic_op_t const op_;
   void const *buffer_;
   uint64_t remote_addr_;
   ucp_rkey_h rkey_;
-  void *reply_buffer_;
-  friend class send_awaitable<rma_atomic_awaitable<T>>;
+  [[no_unique_address]] detail::policy_field<Fetch, void *> reply_buffer_;
+  friend base_type;
 
 public:
   rma_atomic_awaitable(ucp_ep_h ep, ucp_atomic_op_t const op,
@@ -165,43 +298,66 @@ public:
                        ucp_rkey_h rkey, void *reply_buffer = nullptr)
       : ep_(ep), op_(op), buffer_(buffer), remote_addr_(remote_addr),
         rkey_(rkey), reply_buffer_(reply_buffer) {
+    assert(Fetch == (reply_buffer != nullptr));
     if (op == UCP_ATOMIC_OP_SWAP || op == UCP_ATOMIC_OP_CSWAP) {
-      assert(reply_buffer != nullptr);
+      assert(Fetch);
     }
   }
 
   bool await_ready() noexcept {
-    auto send_param = this->build_param();
-    send_param.op_attr_mask |= UCP_OP_ATTR_FIELD_DATATYPE;
-    send_param.datatype = ucp_dt_make_contig(sizeof(T));
-    if (reply_buffer_ != nullptr) {
-      send_param.op_attr_mask |= UCP_OP_ATTR_FIELD_REPLY_BUFFER;
-      send_param.reply_buffer = reply_buffer_;
+    if (this->rejected()) [[unlikely]] {
+      return true;
+    }
+    auto operand = static_cast<T const *>(buffer_);
+    if constexpr (Fetch) {
+      return this->check_request_ready(post_fetch_atomic<T, Policy>(
+          ep_, op_, operand, remote_addr_, rkey_,
+          static_cast<T *>(reply_buffer_.value), *this));
+    } else {
+      return this->check_request_ready(post_atomic<T, Policy>(
+          ep_, op_, operand, remote_addr_, rkey_, *this));
     }
-    auto request = ::ucp_atomic_op_nbx(ep_, op_, buffer_, 1, remote_addr_,
-                                       rkey_, &send_param);
-    return this->check_request_ready(request);
   }
 };
 
 /* These awaitables are not on "hot" path so they can hold a shared_ptr */
 class endpoint;
+class endpoint_base;
 class ep_flush_awaitable : public send_awaitable<ep_flush_awaitable> {
   std::shared_ptr<endpoint const> endpoint_;
+  ucp_ep_h ep_;
   friend class send_awaitable;
 
 public:
   ep_flush_awaitable(std::shared_ptr<endpoint const> endpoint);
+  ep_flush_awaitable(ucp_ep_h ep);
   bool await_ready() noexcept;
 };
 
 class ep_close_awaitable : public send_awaitable<ep_close_awaitable> {
   std::shared_ptr<endpoint> endpoint_;
+  endpoint_base *base_;
   friend class send_awaitable;
 
 public:
   ep_close_awaitable(std::shared_ptr<endpoint> endpoint);
+  ep_close_awaitable(endpoint_base *endpoint);
+  bool await_ready() noexcept;
+};
+
+/* Resumes with the endpoint's error status once the endpoint fails */
+class ep_failure_awaitable {
+  friend class endpoint_base;
+  endpoint_base *endpoint_;
+  ep_failure_awaitable *next_;
+  std::coroutine_handle<> h_;
+  ucs_status_t status_;
+
+public:
+  ep_failure_awaitable(endpoint_base *endpoint);
   bool await_ready() noexcept;
+  void await_suspend(std::coroutine_handle<> h);
+  ucs_status_t await_resume() const { return status_; }
 };
 
 class worker;
@@ -215,8 +371,40 @@ public:
   bool await_ready() noexcept;
 };
 
+/* Closes every live endpoint of a worker and waits for all close requests */
+class worker_close_all_awaitable : public base_awaitable {
+  struct close_entry {
+    worker_close_all_awaitable *self;
+    ucp_ep_h ep;
+    bool closing;
+  };
+  std::shared_ptr<worker> worker_;
+  ucp_ep_close_mode mode_;
+  std::chrono::steady_clock::time_point deadline_;
+  std::vector<close_entry> entries_;
+  size_t pending_;
+  bool forced_;
+  friend class worker;
+
+  static void flush_cb(void *request, ucs_status_t status, void *user_data);
+  static void close_cb(void *request, ucs_status_t status, void *user_data);
+  void start_flush(close_entry &entry);
+  void start_close(close_entry &entry, bool force);
+  void complete_one();
+  void check_deadline();
+  bool past_deadline() const;
+
+public:
+  worker_close_all_awaitable(std::shared_ptr<worker> worker,
+                             ucp_ep_close_mode mode,
+                             std::chrono::steady_clock::time_point deadline);
+  bool await_ready() noexcept;
+  bool await_suspend(std::coroutine_handle<> h);
+  void await_resume() const {}
+};
+
 /* Common awaitable class for stream-recv-like callbacks */
-class stream_recv_awaitable : base_awaitable {
+class stream_recv_awaitable : public base_awaitable {
 private:
   ucp_ep_h ep_;
   ucp_worker_h worker_;
@@ -227,32 +415,27 @@ private:
 
 public:
   stream_recv_awaitable(ucp_ep_h ep, void *buffer, size_t length)
-      : ep_(ep), received_(0), buffer_(buffer), length_(length) {}
+      : ep_(ep), received_(0), buffer_(buffer), length_(length),
+        request_(nullptr) {}
 
   stream_recv_awaitable(ucp_ep_h ep, ucp_worker_h worker, void *buffer,
                         size_t length, stream_recv_awaitable *&cancel)
       : ep_(ep), worker_(worker), received_(0), buffer_(buffer),
-        length_(length) {
+        length_(length), request_(nullptr) {
     cancel = this;
   }
 
-  static void stream_recv_cb(void *request, ucs_status_t status,
-                             size_t received, void *user_data) {
-    auto self = reinterpret_cast<stream_recv_awaitable *>(user_data);
-    self->status_ = status;
-    self->received_ = received;
-    ::ucp_request_free(request);
-    self->h_.resume();
+  /* Called through the completion layer when the request completes */
+  void on_complete(ucs_status_t status, size_t received) {
+    received_ = received;
+    complete(status);
   }
 
   bool await_ready() noexcept {
-    ucp_request_param_t stream_recv_param;
-    stream_recv_param.op_attr_mask =
-        UCP_OP_ATTR_FIELD_CALLBACK | UCP_OP_ATTR_FIELD_USER_DATA;
-    stream_recv_param.cb.recv_stream = &stream_recv_cb;
-    stream_recv_param.user_data = this;
-    auto request = ::ucp_stream_recv_nbx(ep_, buffer_, length_, &received_,
-                                         &stream_recv_param);
+    if (rejected()) [[unlikely]] {
+      return true;
+    }
+    auto request = post_stream_recv(ep_, buffer_, length_, received_, *this);
 
     if (!check_request_ready(request)) {
       request_ = request;
@@ -263,8 +446,11 @@ public:
   }
 
   bool await_suspend(std::coroutine_handle<> h) {
-    h_ = h;
-    return status_ == UCS_INPROGRESS;
+    if (status_ != UCS_INPROGRESS) {
+      return false;
+    }
+    suspend(h);
+    return true;
   }
 
   size_t await_resume() const {
@@ -279,6 +465,45 @@ public:
   }
 };
 
+/* Receives the data of a rendezvous active message */
+class am_recv_data_awaitable : public base_awaitable {
+  ucp_worker_h worker_;
+  void *data_desc_;
+  void *buffer_;
+  size_t length_;
+  size_t received_;
+
+public:
+  am_recv_data_awaitable(ucp_worker_h worker, void *data_desc, void *buffer,
+                         size_t length)
+      : worker_(worker), data_desc_(data_desc), buffer_(buffer),
+        length_(length), received_(0) {}
+
+  /* Called through the completion layer when the request completes */
+  void on_complete(ucs_status_t status, size_t received) {
+    received_ = received;
+    complete(status);
+  }
+
+  bool await_ready() noexcept {
+    return check_request_ready(post_am_recv_data(
+        worker_, data_desc_, buffer_, length_, received_, *this));
+  }
+
+  bool await_suspend(std::coroutine_handle<> h) {
+    if (status_ != UCS_INPROGRESS) {
+      return false;
+    }
+    suspend(h);
+    return true;
+  }
+
+  size_t await_resume() const {
+    check_ucs_status(status_, "failed to receive active message data");
+    return received_;
+  }
+};
+
 /* Common awaitable class for tag-recv-like callbacks */
 class tag_recv_awaitable : public base_awaitable {
 
@@ -289,13 +514,15 @@ private:
   size_t length_;
   ucp_tag_t tag_;
   ucp_tag_t tag_mask_;
+  ucp_datatype_t datatype_;
   ucp_tag_recv_info_t recv_info_;
 
 public:
   tag_recv_awaitable(ucp_worker_h worker, void *buffer, size_t length,
-                     ucp_tag_t tag, ucp_tag_t tag_mask)
+                     ucp_tag_t tag, ucp_tag_t tag_mask,
+                     ucp_datatype_t datatype = ucp_dt_make_contig(1))
       : worker_(worker), request_(nullptr), buffer_(buffer), length_(length),
-        tag_(tag), tag_mask_(tag_mask) {}
+        tag_(tag), tag_mask_(tag_mask), datatype_(datatype) {}
 
   tag_recv_awaitable(ucp_worker_h worker, void *buffer, size_t length,
                      ucp_tag_t tag, ucp_tag_t tag_mask,
@@ -304,28 +531,17 @@ public:
     cancel = this;
   }
 
-  static void tag_recv_cb(void *request, ucs_status_t status,
-                          ucp_tag_recv_info_t const *tag_info,
-                          void *user_data) {
-    auto self = reinterpret_cast<tag_recv_awaitable *>(user_data);
-    self->status_ = status;
-    self->recv_info_.length = tag_info->length;
-    self->recv_info_.sender_tag = tag_info->sender_tag;
-    ::ucp_request_free(request);
-    self->h_.resume();
+  /* Called through the completion layer when the request completes */
+  void on_complete(ucs_status_t status, ucp_tag_recv_info_t const &info) {
+    status_ = status;
+    recv_info_.length = info.length;
+    recv_info_.sender_tag = info.sender_tag;
+    detail::resume(h_);
   }
 
   bool await_ready() noexcept {
-    ucp_request_param_t tag_recv_param;
-    tag_recv_param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
-                                  UCP_OP_ATTR_FIELD_USER_DATA |
-                                  UCP_OP_ATTR_FIELD_RECV_INFO;
-    tag_recv_param.cb.recv = &tag_recv_cb;
-    tag_recv_param.user_data = this;
-    tag_recv_param.recv_info.tag_info = &recv_info_;
-
-    auto request = ::ucp_tag_recv_nbx(worker_, buffer_, length_, tag_,
-                                      tag_mask_, &tag_recv_param);
+    auto request = post_tag_recv(worker_, buffer_, length_, tag_, tag_mask_,
+                                 recv_info_, *this, datatype_);
 
     if (!check_request_ready(request)) {
       request_ = request;
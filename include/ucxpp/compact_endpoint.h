@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/address.h"
+#include "ucxpp/awaitable.h"
+#include "ucxpp/endpoint.h"
+#include "ucxpp/task.h"
+#include "ucxpp/worker.h"
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/slab.h"
+
+namespace ucxpp {
+
+class endpoint_pool;
+
+/**
+ * @brief A UCX endpoint with a small footprint for processes with many
+ * endpoints. It does not keep the peer's address after creation, holds a plain
+ * reference to its worker and is allocated from an endpoint_pool.
+ *
+ */
+class compact_endpoint : public endpoint_base {
+  friend class endpoint_pool;
+  worker *worker_;
+
+  compact_endpoint(worker &worker, ucp_address_t const *address,
+                   ucp_err_handling_mode_t err_mode);
+
+public:
+  /**
+   * @brief Get the worker object
+   *
+   * @return worker& The endpoint's worker
+   */
+  worker &worker_ref() const;
+
+  /**
+   * @brief Print the endpoint's information
+   *
+   */
+  void print() const;
+
+  /**
+   * @brief Get the endpoint's native UCX handle
+   *
+   * @return ucp_ep_h The endpoint's native UCX handle
+   */
+  ucp_ep_h handle() const;
+
+  /**
+   * \copydoc endpoint::stream_send
+   *
+   */
+  stream_send_awaitable stream_send(void const *buffer, size_t length) const;
+
+  /**
+   * \copydoc endpoint::stream_recv
+   *
+   */
+  stream_recv_awaitable stream_recv(void *buffer, size_t length) const;
+
+  /**
+   * \copydoc endpoint::tag_send
+   *
+   */
+  tag_send_awaitable tag_send(void const *buffer, size_t length,
+                              ucp_tag_t tag) const;
+
+  /**
+   * \copydoc endpoint::flush
+   *
+   */
+  ep_flush_awaitable flush() const;
+
+  /**
+   * \copydoc endpoint::close
+   *
+   */
+  task<void> close();
+
+  /**
+   * @brief Destroy the endpoint object. If the endpoint is not closed yet, it
+   * will be closed.
+   *
+   */
+  ~compact_endpoint();
+};
+
+/**
+ * @brief Creates compact endpoints on one worker from slab storage. The pool
+ * must outlive all the endpoints it creates.
+ *
+ */
+class endpoint_pool : public noncopyable {
+  std::shared_ptr<worker> worker_;
+  detail::slab<compact_endpoint> slab_;
+  ucp_err_handling_mode_t err_mode_;
+
+public:
+  /**
+   * @brief Returns a compact endpoint to the pool it was created from
+   *
+   */
+  struct deleter {
+    endpoint_pool *pool;
+    void operator()(compact_endpoint *ep) const;
+  };
+
+  using pointer = std::unique_ptr<compact_endpoint, deleter>;
+
+  /**
+   * @brief Construct a new endpoint pool object
+   *
+   * @param worker UCX worker for all endpoints in the pool
+   * @param chunk_size Number of endpoints allocated at once when the pool
+   * grows
+   * @param err_mode Error handling mode for all endpoints in the pool
+   */
+  endpoint_pool(std::shared_ptr<worker> worker, size_t chunk_size = 1024,
+                ucp_err_handling_mode_t err_mode = UCP_ERR_HANDLING_MODE_NONE);
+
+  /**
+   * @brief Create a compact endpoint. The address is not copied.
+   *
+   * @param peer Remote UCX address
+   * @return pointer The created endpoint
+   */
+  pointer create(remote_address const &peer);
+
+  /**
+   * @brief Create a compact endpoint. The address is not referenced after
+   * this call.
+   *
+   * @param address Remote UCP address
+   * @return pointer The created endpoint
+   */
+  pointer create(ucp_address_t const *address);
+
+  /**
+   * @brief Get the number of live endpoints created from this pool
+   *
+   * @return size_t The number of live endpoints
+   */
+  size_t size() const;
+
+  /**
+   * @brief Get the worker object
+   *
+   * @return std::shared_ptr<worker> The pool's worker
+   */
+  std::shared_ptr<worker> worker_ptr() const;
+};
+
+} // namespace ucxpp
\ No newline at end of file
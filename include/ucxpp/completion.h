@@ -0,0 +1,382 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <ucp/api/ucp.h>
+
+namespace ucxpp {
+
+/**
+ * @brief Compile-time attributes of a send-like request. The request
+ * parameters of each combination are built without branches.
+ *
+ * @tparam Flags UCP_OP_ATTR_FLAG_* bits, e.g. UCP_OP_ATTR_FLAG_FAST_CMPL
+ * @tparam Datatype Whether the operation carries a datatype other than bytes
+ * @tparam Memh Whether the operation carries the memory handle of its buffer
+ */
+template <uint32_t Flags = UCP_OP_ATTR_FLAG_MULTI_SEND, bool Datatype = false,
+          bool Memh = false>
+struct op_policy {
+  static constexpr uint32_t kFlags = Flags;
+  static constexpr bool kDatatype = Datatype;
+  static constexpr bool kMemh = Memh;
+};
+
+using default_op_policy = op_policy<>;
+
+/* Used by operations on objects packed through a generic datatype */
+using datatype_op_policy = op_policy<UCP_OP_ATTR_FLAG_MULTI_SEND, true>;
+
+/**
+ * @brief Adapts a callable to a completion object without allocating. The
+ * callable receives the same arguments as on_complete().
+ *
+ * @tparam F The callable type
+ */
+template <class F> class callback {
+  F fn_;
+
+public:
+  explicit callback(F fn) : fn_(std::move(fn)) {}
+
+  template <class... Args> void on_complete(Args &&...args) {
+    fn_(std::forward<Args>(args)...);
+  }
+};
+
+namespace detail {
+
+template <class Completion>
+void send_cb(void *request, ucs_status_t status, void *user_data) {
+  ::ucp_request_free(request);
+  static_cast<Completion *>(user_data)->on_complete(status);
+}
+
+template <class Completion>
+void stream_recv_cb(void *request, ucs_status_t status, size_t length,
+                    void *user_data) {
+  ::ucp_request_free(request);
+  static_cast<Completion *>(user_data)->on_complete(status, length);
+}
+
+template <class Completion>
+void tag_recv_cb(void *request, ucs_status_t status,
+                 ucp_tag_recv_info_t const *info, void *user_data) {
+  ::ucp_request_free(request);
+  static_cast<Completion *>(user_data)->on_complete(status, *info);
+}
+
+template <class Completion>
+void am_recv_data_cb(void *request, ucs_status_t status, size_t length,
+                     void *user_data) {
+  ::ucp_request_free(request);
+  static_cast<Completion *>(user_data)->on_complete(status, length);
+}
+
+template <class Policy, class Completion>
+ucp_request_param_t send_param(Completion &completion,
+                               ucp_datatype_t datatype = ucp_dt_make_contig(1),
+                               ucp_mem_h memh = nullptr) {
+  ucp_request_param_t param;
+  param.op_attr_mask =
+      UCP_OP_ATTR_FIELD_CALLBACK | UCP_OP_ATTR_FIELD_USER_DATA |
+      (Policy::kDatatype ? UCP_OP_ATTR_FIELD_DATATYPE : 0) |
+      (Policy::kMemh ? UCP_OP_ATTR_FIELD_MEMH : 0) | Policy::kFlags;
+  param.cb.send = &send_cb<Completion>;
+  param.user_data = std::addressof(completion);
+  if constexpr (Policy::kDatatype) {
+    param.datatype = datatype;
+  }
+  if constexpr (Policy::kMemh) {
+    param.memh = memh;
+  }
+  return param;
+}
+
+} // namespace detail
+
+/*
+ * Callback-based operations. Each post_* function issues one operation and
+ * returns what UCX returns: nullptr if it completed immediately, an error
+ * pointer if it failed, or a request that finishes later by calling
+ * completion.on_complete(). on_complete() is only called in the last case,
+ * from the worker's progress(), and the completion object must stay valid
+ * until then. No memory is allocated, and endpoint failures are not tracked.
+ */
+
+/**
+ * @brief Stream send the buffer
+ *
+ * @tparam Policy An op_policy for the request attributes
+ * @param ep The UCX endpoint
+ * @param buffer The buffer to send
+ * @param length The length of the buffer
+ * @param completion Called as on_complete(ucs_status_t)
+ * @param datatype The datatype, if the policy carries one
+ * @param memh The memory handle of the buffer, if the policy carries one
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Policy = default_op_policy, class Completion>
+ucs_status_ptr_t
+post_stream_send(ucp_ep_h ep, void const *buffer, size_t length,
+                 Completion &completion,
+                 ucp_datatype_t datatype = ucp_dt_make_contig(1),
+                 ucp_mem_h memh = nullptr) {
+  auto param = detail::send_param<Policy>(completion, datatype, memh);
+  return ::ucp_stream_send_nbx(ep, buffer, length, &param);
+}
+
+/**
+ * @brief Tag send the buffer
+ *
+ * @tparam Policy An op_policy for the request attributes
+ * @param ep The UCX endpoint
+ * @param buffer The buffer to send
+ * @param length The length of the buffer
+ * @param tag The tag to send with
+ * @param completion Called as on_complete(ucs_status_t)
+ * @param datatype The datatype, if the policy carries one
+ * @param memh The memory handle of the buffer, if the policy carries one
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Policy = default_op_policy, class Completion>
+ucs_status_ptr_t post_tag_send(ucp_ep_h ep, void const *buffer, size_t length,
+                               ucp_tag_t tag, Completion &completion,
+                               ucp_datatype_t datatype = ucp_dt_make_contig(1),
+                               ucp_mem_h memh = nullptr) {
+  auto param = detail::send_param<Policy>(completion, datatype, memh);
+  return ::ucp_tag_send_nbx(ep, buffer, length, tag, &param);
+}
+
+/**
+ * @brief Send an active message
+ *
+ * @param ep The UCX endpoint
+ * @param id The active message id
+ * @param header The user header
+ * @param header_length The length of the user header
+ * @param buffer The payload
+ * @param length The length of the payload
+ * @param flags UCP_AM_SEND_FLAG_* bits
+ * @param completion Called as on_complete(ucs_status_t)
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Completion>
+ucs_status_ptr_t post_am_send(ucp_ep_h ep, unsigned id, void const *header,
+                              size_t header_length, void const *buffer,
+                              size_t length, uint32_t flags,
+                              Completion &completion) {
+  auto param = detail::send_param<default_op_policy>(completion);
+  param.op_attr_mask |= UCP_OP_ATTR_FIELD_FLAGS;
+  param.flags = flags;
+  return ::ucp_am_send_nbx(ep, id, header, header_length, buffer, length,
+                           &param);
+}
+
+/**
+ * @brief Write to remote memory
+ *
+ * @tparam Policy An op_policy for the request attributes
+ * @param ep The UCX endpoint
+ * @param buffer Local buffer to write from
+ * @param length Length of the buffer
+ * @param remote_addr Remote address to write to
+ * @param rkey The unpacked remote key
+ * @param completion Called as on_complete(ucs_status_t)
+ * @param memh The memory handle of the buffer, if the policy carries one
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Policy = default_op_policy, class Completion>
+ucs_status_ptr_t post_put(ucp_ep_h ep, void const *buffer, size_t length,
+                          uint64_t remote_addr, ucp_rkey_h rkey,
+                          Completion &completion, ucp_mem_h memh = nullptr) {
+  auto param =
+      detail::send_param<Policy>(completion, ucp_dt_make_contig(1), memh);
+  return ::ucp_put_nbx(ep, buffer, length, remote_addr, rkey, &param);
+}
+
+/**
+ * @brief Read from remote memory
+ *
+ * @tparam Policy An op_policy for the request attributes
+ * @param ep The UCX endpoint
+ * @param buffer Local buffer to read into
+ * @param length Length of the buffer
+ * @param remote_addr Remote address to read from
+ * @param rkey The unpacked remote key
+ * @param completion Called as on_complete(ucs_status_t)
+ * @param memh The memory handle of the buffer, if the policy carries one
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Policy = default_op_policy, class Completion>
+ucs_status_ptr_t post_get(ucp_ep_h ep, void *buffer, size_t length,
+                          uint64_t remote_addr, ucp_rkey_h rkey,
+                          Completion &completion, ucp_mem_h memh = nullptr) {
+  auto param =
+      detail::send_param<Policy>(completion, ucp_dt_make_contig(1), memh);
+  return ::ucp_get_nbx(ep, buffer, length, remote_addr, rkey, &param);
+}
+
+/**
+ * @brief Apply an atomic operation to remote memory
+ *
+ * @tparam T The operand type, 4 or 8 bytes long
+ * @tparam Policy An op_policy for the request attributes
+ * @param ep The UCX endpoint
+ * @param op The atomic operation
+ * @param operand The local operand
+ * @param remote_addr The remote address
+ * @param rkey The unpacked remote key
+ * @param completion Called as on_complete(ucs_status_t)
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class T, class Policy = default_op_policy, class Completion>
+ucs_status_ptr_t post_atomic(ucp_ep_h ep, ucp_atomic_op_t op,
+                             T const *operand, uint64_t remote_addr,
+                             ucp_rkey_h rkey, Completion &completion) {
+  static_assert(!Policy::kDatatype, "The datatype is implied by T");
+  auto param = detail::send_param<Policy>(completion);
+  param.op_attr_mask |= UCP_OP_ATTR_FIELD_DATATYPE;
+  param.datatype = ucp_dt_make_contig(sizeof(T));
+  return ::ucp_atomic_op_nbx(ep, op, operand, 1, remote_addr, rkey, &param);
+}
+
+/**
+ * @brief Apply an atomic operation to remote memory and fetch the old value
+ *
+ * @tparam T The operand type, 4 or 8 bytes long
+ * @tparam Policy An op_policy for the request attributes
+ * @param ep The UCX endpoint
+ * @param op The atomic operation
+ * @param operand The local operand
+ * @param remote_addr The remote address
+ * @param rkey The unpacked remote key
+ * @param reply Receives the old value. For compare-and-swap it holds the
+ * desired value on input.
+ * @param completion Called as on_complete(ucs_status_t)
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class T, class Policy = default_op_policy, class Completion>
+ucs_status_ptr_t post_fetch_atomic(ucp_ep_h ep, ucp_atomic_op_t op,
+                                   T const *operand, uint64_t remote_addr,
+                                   ucp_rkey_h rkey, T *reply,
+                                   Completion &completion) {
+  static_assert(!Policy::kDatatype, "The datatype is implied by T");
+  auto param = detail::send_param<Policy>(completion);
+  param.op_attr_mask |=
+      UCP_OP_ATTR_FIELD_DATATYPE | UCP_OP_ATTR_FIELD_REPLY_BUFFER;
+  param.datatype = ucp_dt_make_contig(sizeof(T));
+  param.reply_buffer = reply;
+  return ::ucp_atomic_op_nbx(ep, op, operand, 1, remote_addr, rkey, &param);
+}
+
+/**
+ * @brief Flush all outstanding operations of an endpoint
+ *
+ * @param ep The UCX endpoint
+ * @param completion Called as on_complete(ucs_status_t)
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Completion>
+ucs_status_ptr_t post_ep_flush(ucp_ep_h ep, Completion &completion) {
+  auto param = detail::send_param<default_op_policy>(completion);
+  return ::ucp_ep_flush_nbx(ep, &param);
+}
+
+/**
+ * @brief Flush all outstanding operations of a worker
+ *
+ * @param worker The UCX worker
+ * @param completion Called as on_complete(ucs_status_t)
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Completion>
+ucs_status_ptr_t post_worker_flush(ucp_worker_h worker,
+                                   Completion &completion) {
+  auto param = detail::send_param<default_op_policy>(completion);
+  return ::ucp_worker_flush_nbx(worker, &param);
+}
+
+/**
+ * @brief Stream receive to the buffer
+ *
+ * @param ep The UCX endpoint
+ * @param buffer The buffer to receive to
+ * @param length The length of the buffer
+ * @param received Set to the received length on immediate completion
+ * @param completion Called as on_complete(ucs_status_t, size_t received)
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Completion>
+ucs_status_ptr_t post_stream_recv(ucp_ep_h ep, void *buffer, size_t length,
+                                  size_t &received, Completion &completion) {
+  ucp_request_param_t param;
+  param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK | UCP_OP_ATTR_FIELD_USER_DATA;
+  param.cb.recv_stream = &detail::stream_recv_cb<Completion>;
+  param.user_data = std::addressof(completion);
+  return ::ucp_stream_recv_nbx(ep, buffer, length, &received, &param);
+}
+
+/**
+ * @brief Tag receive to the buffer
+ *
+ * @param worker The UCX worker
+ * @param buffer The buffer to receive to
+ * @param length The length of the buffer
+ * @param tag The tag to match
+ * @param tag_mask The bits of the tag to match
+ * @param info Filled in on immediate completion
+ * @param completion Called as on_complete(ucs_status_t,
+ * ucp_tag_recv_info_t const &)
+ * @param datatype The datatype of the buffer
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Completion>
+ucs_status_ptr_t
+post_tag_recv(ucp_worker_h worker, void *buffer, size_t length, ucp_tag_t tag,
+              ucp_tag_t tag_mask, ucp_tag_recv_info_t &info,
+              Completion &completion,
+              ucp_datatype_t datatype = ucp_dt_make_contig(1)) {
+  ucp_request_param_t param;
+  param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                       UCP_OP_ATTR_FIELD_USER_DATA |
+                       UCP_OP_ATTR_FIELD_RECV_INFO;
+  param.cb.recv = &detail::tag_recv_cb<Completion>;
+  param.user_data = std::addressof(completion);
+  param.recv_info.tag_info = &info;
+  if (datatype != ucp_dt_make_contig(1)) [[unlikely]] {
+    param.op_attr_mask |= UCP_OP_ATTR_FIELD_DATATYPE;
+    param.datatype = datatype;
+  }
+  return ::ucp_tag_recv_nbx(worker, buffer, length, tag, tag_mask, &param);
+}
+
+/**
+ * @brief Receive the data of a rendezvous active message
+ *
+ * @param worker The UCX worker
+ * @param data_desc The data descriptor passed to the active message handler
+ * @param buffer The buffer to receive to
+ * @param length The length of the buffer
+ * @param received Set to the received length on immediate completion
+ * @param completion Called as on_complete(ucs_status_t, size_t received)
+ * @return ucs_status_ptr_t The UCX status pointer
+ */
+template <class Completion>
+ucs_status_ptr_t post_am_recv_data(ucp_worker_h worker, void *data_desc,
+                                   void *buffer, size_t length,
+                                   size_t &received, Completion &completion) {
+  ucp_request_param_t param;
+  param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                       UCP_OP_ATTR_FIELD_USER_DATA |
+                       UCP_OP_ATTR_FIELD_RECV_INFO;
+  param.cb.recv_am = &detail::am_recv_data_cb<Completion>;
+  param.user_data = std::addressof(completion);
+  param.recv_info.length = &received;
+  return ::ucp_am_recv_data_nbx(worker, data_desc, buffer, length, &param);
+}
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/detail/ring.h"
+
+namespace ucxpp {
+
+/**
+ * @brief The outcome of one operation posted with a queued_completion
+ *
+ */
+struct completion_record {
+  /* The context given to the queued_completion */
+  void *context;
+  ucs_status_t status;
+  /* The received length, or 0 for sends */
+  size_t length;
+  /* The sender tag of tag receives, or 0 */
+  ucp_tag_t sender_tag;
+};
+
+/**
+ * @brief A ring of completion records. Operations posted with a
+ * queued_completion only append a record from the UCX callback, and the
+ * application handles the records in batches after worker::progress()
+ * returns, so its code never runs nested inside UCX.
+ *
+ */
+class completion_queue {
+  detail::ring<completion_record> records_;
+
+public:
+  /**
+   * @brief Construct a new completion queue object
+   *
+   * @param capacity Initial number of records. The ring grows when a
+   * completion finds it full, so size it for the peak number of operations in
+   * flight.
+   */
+  explicit completion_queue(size_t capacity = 256);
+
+  void push(completion_record const &record) { records_.push(record); }
+
+  bool empty() const { return records_.empty(); }
+
+  /**
+   * @brief Get the number of records not handled yet
+   *
+   * @return size_t The number of queued records
+   */
+  size_t size() const { return records_.size(); }
+
+  /**
+   * @brief Move up to max records, oldest first, into an array
+   *
+   * @param records The array to fill
+   * @param max The length of the array
+   * @return size_t The number of records moved
+   */
+  size_t poll(completion_record *records, size_t max);
+
+  /**
+   * @brief Call fn(completion_record const &) on up to budget records, oldest
+   * first. Records queued by fn are left for the next call.
+   *
+   * @param budget The maximum number of records to handle
+   * @param fn The handler
+   * @return size_t The number of records handled
+   */
+  template <class F> size_t drain(size_t budget, F &&fn) {
+    auto count = records_.size() < budget ? records_.size() : budget;
+    for (size_t i = 0; i < count; ++i) {
+      auto record = records_.pop();
+      fn(static_cast<completion_record const &>(record));
+    }
+    return count;
+  }
+};
+
+/**
+ * @brief A completion object for the post_* functions that appends a record
+ * to a completion_queue. It must stay valid until the operation completes,
+ * and may be reused afterwards.
+ *
+ */
+class queued_completion {
+  completion_queue *queue_;
+  void *context_;
+
+public:
+  /**
+   * @brief Construct a new queued completion object
+   *
+   * @param queue The queue to append to
+   * @param context Copied into the record to identify the operation
+   */
+  queued_completion(completion_queue &queue, void *context)
+      : queue_(&queue), context_(context) {}
+
+  void on_complete(ucs_status_t status) {
+    queue_->push({context_, status, 0, 0});
+  }
+
+  void on_complete(ucs_status_t status, size_t length) {
+    queue_->push({context_, status, length, 0});
+  }
+
+  void on_complete(ucs_status_t status, ucp_tag_recv_info_t const &info) {
+    queue_->push({context_, status, info.length, info.sender_tag});
+  }
+
+  /**
+   * @brief Append the record of an operation that did not return a request,
+   * so that every posted operation yields exactly one record
+   *
+   * @param request What the post_* function returned
+   * @param length The received length, for receives
+   * @param sender_tag The sender tag, for tag receives
+   */
+  void posted(ucs_status_ptr_t request, size_t length = 0,
+              ucp_tag_t sender_tag = 0) {
+    if (!UCS_PTR_IS_PTR(request)) [[unlikely]] {
+      queue_->push({context_, UCS_PTR_STATUS(request), length, sender_tag});
+    }
+  }
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -8,9 +9,12 @@
 #include <memory>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <string>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <utility>
+#include <vector>
 
 #include <ucp/api/ucp.h>
 
@@ -27,14 +31,29 @@ class context : public std::enable_shared_from_this<context> {
   uint64_t features_;
 
 public:
+  /**
+   * @brief Time spent in each phase of context creation
+   *
+   */
+  struct startup_stats {
+    std::chrono::nanoseconds config_read;
+    std::chrono::nanoseconds config_modify;
+    std::chrono::nanoseconds init;
+  };
+
   /**
    * @brief Context builder
    *
    */
   class builder {
+    friend class context;
     uint64_t features_;
     bool print_config_;
+    bool print_startup_stats_;
     bool enable_mt_;
+    size_t estimated_num_eps_;
+    size_t estimated_num_ppn_;
+    std::vector<std::pair<std::string, std::string>> config_;
 
   public:
     builder();
@@ -107,8 +126,94 @@ public:
      * @return builder&
      */
     builder &enable_mt();
+
+    /**
+     * @brief Print the time spent in each startup phase to stdout when
+     * building context
+     *
+     * @return builder&
+     */
+    builder &enable_print_startup_stats();
+
+    /**
+     * @brief Set a UCX configuration option, overriding the environment
+     *
+     * @param name The name of the option without the UCX_ prefix, e.g. TLS
+     * @param value The value of the option
+     * @return builder&
+     */
+    builder &set_config(std::string const &name, std::string const &value);
+
+    /**
+     * @brief Restrict the transports UCX probes at startup (UCX_TLS)
+     *
+     * @param transports Comma-separated transport list, e.g. "self,sm,tcp"
+     * @return builder&
+     */
+    builder &transports(std::string const &transports);
+
+    /**
+     * @brief Restrict the network devices UCX probes at startup
+     * (UCX_NET_DEVICES)
+     *
+     * @param devices Comma-separated device list, e.g. "mlx5_0:1"
+     * @return builder&
+     */
+    builder &devices(std::string const &devices);
+
+    /**
+     * @brief Hint the estimated number of endpoints in this context
+     *
+     * @param num_eps Estimated number of endpoints
+     * @return builder&
+     */
+    builder &estimated_num_eps(size_t num_eps);
+
+    /**
+     * @brief Hint the estimated number of processes per node
+     *
+     * @param num_ppn Estimated number of processes per node
+     * @return builder&
+     */
+    builder &estimated_num_ppn(size_t num_ppn);
+
+    /**
+     * @brief Apply a named startup profile. Supported profiles are
+     * "local-only" (self and shared memory), "tcp" (local plus TCP) and
+     * "network" (local plus RDMA and TCP).
+     *
+     * @param name The profile name
+     * @return builder&
+     */
+    builder &use_profile(std::string const &name);
+
+    /**
+     * @brief Enable keepalive so that endpoints in peer error handling mode
+     * detect dead peers without traffic (UCX_KEEPALIVE_INTERVAL)
+     *
+     * @param interval Keepalive interval, e.g. "1s"
+     * @param num_eps Maximum number of endpoints checked per interval, 0 to
+     * keep the UCX default
+     * @return builder&
+     */
+    builder &keepalive(std::string const &interval, size_t num_eps = 0);
+
+    /**
+     * @brief Load UCX configuration options from a profile file, such as the
+     * one written by the autotune example. Each non-empty line that does not
+     * start with '#' has the form NAME=VALUE, where NAME may carry the UCX_
+     * prefix.
+     *
+     * @param filename The profile file to load
+     * @return builder&
+     */
+    builder &load_profile(std::string const &filename);
   };
 
+private:
+  startup_stats startup_stats_;
+
+public:
   /**
    * @brief Construct a new context object
    *
@@ -118,6 +223,20 @@ public:
    */
   context(uint64_t features, bool print_config, bool enable_mt);
 
+  /**
+   * @brief Construct a new context object from a builder
+   *
+   * @param builder The builder holding the options
+   */
+  context(builder const &builder);
+
+  /**
+   * @brief Get the time spent in each phase of context creation
+   *
+   * @return startup_stats The startup phase timings
+   */
+  startup_stats const &get_startup_stats() const;
+
   /**
    * @brief Get the features of the context
    *
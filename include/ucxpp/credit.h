@@ -0,0 +1,157 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/awaitable.h"
+#include "ucxpp/endpoint.h"
+#include "ucxpp/task.h"
+#include "ucxpp/worker.h"
+
+#include "ucxpp/detail/noncopyable.h"
+
+namespace ucxpp {
+
+class credit_sender;
+
+/* Suspends until the sender holds a credit and takes it */
+class credit_awaitable {
+  friend class credit_sender;
+  struct state;
+  state *state_;
+  credit_awaitable *next_;
+  std::coroutine_handle<> h_;
+
+public:
+  credit_awaitable(state *state);
+  bool await_ready() noexcept;
+  void await_suspend(std::coroutine_handle<> h);
+  void await_resume() const {}
+};
+
+/**
+ * @brief The sending side of the credit protocol. Every message takes one
+ * credit. Credits arrive as credit messages on the sender's worker, or from
+ * the application when the receiver piggybacks them on its own messages.
+ * Credit messages are received with a worker-wide tag receive that matches
+ * the exact credit tag from any endpoint, so two senders on one worker sharing
+ * a tag take each other's credits. Derive the tag from a per-connection id.
+ *
+ */
+class credit_sender : public noncopyable {
+  std::shared_ptr<endpoint> endpoint_;
+  std::shared_ptr<credit_awaitable::state> state_;
+
+  static task<void>
+  receive_credits(std::shared_ptr<worker> worker,
+                  std::shared_ptr<credit_awaitable::state> state,
+                  ucp_tag_t credit_tag);
+
+public:
+  /**
+   * @brief Construct a new credit sender object. A credit receive is posted
+   * on the endpoint's worker until the sender is destroyed.
+   *
+   * @param endpoint The endpoint to send messages to
+   * @param credit_tag The tag of credit messages from the receiver, unique
+   * among the credit senders of the endpoint's worker
+   * @param initial_credits Credits agreed with the receiver beforehand
+   */
+  credit_sender(std::shared_ptr<endpoint> endpoint, ucp_tag_t credit_tag,
+                size_t initial_credits = 0);
+
+  /**
+   * @brief Take one credit
+   *
+   * @return credit_awaitable A coroutine that returns when a credit is taken
+   */
+  credit_awaitable acquire();
+
+  /**
+   * @brief Add credits piggybacked on an application message
+   *
+   * @param credits The number of credits granted
+   */
+  void add_credits(size_t credits);
+
+  /**
+   * @brief Get the number of credits available
+   *
+   * @return size_t The number of credits available
+   */
+  size_t credits() const;
+
+  /**
+   * @brief Tag send the buffer once a credit is taken
+   *
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param tag The tag to send with
+   * @return task<void> A coroutine that returns upon completion
+   */
+  task<void> tag_send(void const *buffer, size_t length, ucp_tag_t tag) const;
+
+  /**
+   * @brief Destroy the credit sender object and cancel the credit receive.
+   * No sender may be waiting for a credit.
+   *
+   */
+  ~credit_sender();
+};
+
+/**
+ * @brief The receiving side of the credit protocol. The application grants
+ * one credit for every receive it posts. Credits are sent back in batches, or
+ * taken for piggybacking on the application's own messages.
+ *
+ */
+class credit_receiver : public noncopyable {
+  std::shared_ptr<endpoint> endpoint_;
+  ucp_tag_t credit_tag_;
+  size_t batch_;
+  size_t pending_;
+
+  task<void> send_credits(size_t credits) const;
+
+public:
+  /**
+   * @brief Construct a new credit receiver object
+   *
+   * @param endpoint The endpoint back to the sender
+   * @param credit_tag The tag of credit messages, which must be the one only
+   * this receiver's sender listens on
+   * @param batch The number of pending credits that triggers a credit message
+   */
+  credit_receiver(std::shared_ptr<endpoint> endpoint, ucp_tag_t credit_tag,
+                  size_t batch = 1);
+
+  /**
+   * @brief Grant credits, usually one per posted receive
+   *
+   * @param credits The number of credits to grant
+   * @return task<void> A coroutine that returns when any credit message sent
+   * is completed
+   */
+  task<void> grant(size_t credits = 1);
+
+  /**
+   * @brief Send all pending credits
+   *
+   * @return task<void> A coroutine that returns upon completion
+   */
+  task<void> flush();
+
+  /**
+   * @brief Take the pending credits for piggybacking. The sender passes them
+   * to credit_sender::add_credits().
+   *
+   * @return size_t The number of pending credits taken
+   */
+  size_t take_piggyback();
+};
+
+} // namespace ucxpp
\ No newline at end of file
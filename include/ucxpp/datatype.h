@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/error.h"
+
+#include "ucxpp/detail/noncopyable.h"
+
+namespace ucxpp {
+
+/**
+ * @brief Describes how UCX packs an object of type T fragment by fragment.
+ * Specialize it with:
+ *
+ * static size_t packed_size(T const &value);
+ * static size_t pack(T const &value, size_t offset, void *dest,
+ *                    size_t max_length);
+ * static ucs_status_t unpack(T &value, size_t offset, void const *src,
+ *                           size_t length);
+ *
+ * pack() writes up to max_length bytes of the packed form starting at offset
+ * and returns the number written. unpack() is given the fragments of a
+ * received message in order. A receive accepts messages up to
+ * packed_size(value), unless the traits also define
+ * static size_t max_packed_size(T const &value).
+ *
+ * @tparam T The object type
+ */
+template <class T> struct pack_traits;
+
+/**
+ * @brief A UCX generic datatype built from pack_traits<T>. UCX calls the
+ * traits to pack straight from the object into its own eager or rendezvous
+ * buffers and to unpack into the receiving object, so no temporary buffer is
+ * needed. Operations using it pass a pointer to one object and a count of 1.
+ *
+ * @tparam T The object type
+ */
+template <class T> class generic_datatype : public noncopyable {
+  /* The state is the object pointer, with the low bit set when unpacking */
+  static_assert(alignof(T) >= 2, "the low pointer bit tags unpack states");
+  using traits = pack_traits<T>;
+
+  ucp_datatype_t datatype_;
+
+  static T *object(void *state) {
+    return reinterpret_cast<T *>(reinterpret_cast<uintptr_t>(state) &
+                                 ~uintptr_t(1));
+  }
+
+  static bool unpacking(void *state) {
+    return reinterpret_cast<uintptr_t>(state) & 1;
+  }
+
+  static void *start_pack(void *, void const *buffer, size_t count) {
+    assert(count == 1);
+    (void)count;
+    return const_cast<void *>(buffer);
+  }
+
+  static void *start_unpack(void *, void *buffer, size_t count) {
+    assert(count == 1);
+    (void)count;
+    return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(buffer) | 1);
+  }
+
+  static size_t packed_size(void *state) {
+    auto value = object(state);
+    if constexpr (requires { traits::max_packed_size(*value); }) {
+      if (unpacking(state)) {
+        return traits::max_packed_size(*value);
+      }
+    }
+    return traits::packed_size(*value);
+  }
+
+  static size_t pack(void *state, size_t offset, void *dest,
+                     size_t max_length) {
+    return traits::pack(*object(state), offset, dest, max_length);
+  }
+
+  static ucs_status_t unpack(void *state, size_t offset, void const *src,
+                             size_t length) {
+    return traits::unpack(*object(state), offset, src, length);
+  }
+
+  static void finish(void *) {}
+
+public:
+  generic_datatype() {
+    static ucp_generic_dt_ops_t ops = {&start_pack,  &start_unpack,
+                                       &packed_size, &pack,
+                                       &unpack,      &finish};
+    check_ucs_status(::ucp_dt_create_generic(&ops, nullptr, &datatype_),
+                     "failed to create generic datatype");
+  }
+
+  /**
+   * @brief Get the datatype for T, created on first use
+   *
+   * @return generic_datatype const& The datatype
+   */
+  static generic_datatype const &instance() {
+    static generic_datatype datatype;
+    return datatype;
+  }
+
+  /**
+   * @brief Get the UCX datatype handle
+   *
+   * @return ucp_datatype_t The datatype handle
+   */
+  ucp_datatype_t handle() const { return datatype_; }
+
+  ~generic_datatype() { ::ucp_dt_destroy(datatype_); }
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+namespace ucxpp {
+namespace detail {
+
+/**
+ * @brief A field that only takes storage when a compile-time policy enables
+ * it. Use it with [[no_unique_address]] so that disabled fields add no bytes.
+ *
+ * @tparam Enabled Whether the field is stored
+ * @tparam T The field type
+ */
+template <bool Enabled, class T> struct policy_field {
+  T value;
+  policy_field(T v) : value(v) {}
+};
+
+template <class T> struct policy_field<false, T> {
+  policy_field(T) {}
+};
+
+} // namespace detail
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <coroutine>
+#include <utility>
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/ring.h"
+
+namespace ucxpp {
+namespace detail {
+
+using resume_ring = ring<std::coroutine_handle<>>;
+
+/* Set by a worker in queued completion mode while UCX calls back into it */
+extern thread_local resume_ring *deferred_resumes;
+
+/**
+ * @brief Resume a coroutine from a completion callback. Inside the progress()
+ * of a worker in queued completion mode, the coroutine is queued on the
+ * worker instead, so it runs after UCX has returned.
+ *
+ * @param h The coroutine to resume
+ */
+inline void resume(std::coroutine_handle<> h) {
+  if (auto queue = deferred_resumes) [[unlikely]] {
+    queue->push(h);
+  } else {
+    h.resume();
+  }
+}
+
+/**
+ * @brief Redirects resume() to a ring while in scope, and restores the outer
+ * redirection on exit, including when UCX throws through it.
+ *
+ */
+class defer_resumes : public noncopyable {
+  resume_ring *outer_;
+
+public:
+  explicit defer_resumes(resume_ring *ring)
+      : outer_(std::exchange(deferred_resumes, ring)) {}
+  ~defer_resumes() { deferred_resumes = outer_; }
+};
+
+/**
+ * @brief Awaited by coroutines started from a UCX callback before they run
+ * application code. Inside the progress() of a worker in queued completion
+ * mode, the coroutine is queued like a completion and continues after UCX has
+ * returned. Otherwise it does not suspend.
+ *
+ */
+struct defer_awaitable {
+  bool await_ready() const noexcept { return deferred_resumes == nullptr; }
+  void await_suspend(std::coroutine_handle<> h) const {
+    deferred_resumes->push(h);
+  }
+  void await_resume() const noexcept {}
+};
+
+} // namespace detail
+} // namespace ucxpp
\ No newline at end of file
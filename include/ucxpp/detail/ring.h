@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ucxpp {
+namespace detail {
+
+/**
+ * @brief FIFO ring of trivially copyable entries. The capacity is a power of
+ * two. It doubles when a push finds the ring full, as pushes come from UCX
+ * callbacks that cannot fail, so size the ring for the peak to keep
+ * reallocation off the fast path.
+ *
+ */
+template <class T> class ring {
+  std::vector<T> slots_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+
+  void grow() {
+    std::vector<T> slots(slots_.empty() ? 64 : slots_.size() * 2);
+    for (size_t i = 0; i < size_; ++i) {
+      slots[i] = slots_[(head_ + i) & (slots_.size() - 1)];
+    }
+    slots_ = std::move(slots);
+    head_ = 0;
+  }
+
+public:
+  ring() = default;
+
+  explicit ring(size_t capacity) {
+    size_t slots = 1;
+    while (slots < capacity) {
+      slots *= 2;
+    }
+    slots_.resize(slots);
+  }
+
+  bool empty() const { return size_ == 0; }
+
+  size_t size() const { return size_; }
+
+  size_t capacity() const { return slots_.size(); }
+
+  void push(T const &value) {
+    if (size_ == slots_.size()) [[unlikely]] {
+      grow();
+    }
+    slots_[(head_ + size_) & (slots_.size() - 1)] = value;
+    ++size_;
+  }
+
+  T pop() {
+    auto value = slots_[head_];
+    head_ = (head_ + 1) & (slots_.size() - 1);
+    --size_;
+    return value;
+  }
+};
+
+} // namespace detail
+} // namespace ucxpp
\ No newline at end of file
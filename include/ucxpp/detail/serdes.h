@@ -1,10 +1,14 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <endian.h>
 #include <netinet/in.h>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace ucxpp {
 namespace detail {
@@ -36,5 +40,252 @@ void deserialize(It &it, T &value) {
   value = ntoh(value);
 }
 
+/* Fixed-width integers and enums are stored in network byte order */
+template <class T>
+using wire_type = typename std::make_unsigned<
+    typename std::conditional<std::is_enum<T>::value,
+                              std::underlying_type<T>,
+                              std::type_identity<T>>::type::type>::type;
+
+/**
+ * @brief Store a value in network byte order at a possibly unaligned address
+ *
+ * @param buffer The destination
+ * @param value The value
+ */
+template <class T> inline void store(void *buffer, T const &value) {
+  static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                "only integers and enums have a wire format");
+  auto raw = static_cast<wire_type<T>>(value);
+  if constexpr (sizeof(T) > 1) {
+    raw = hton(raw);
+  }
+  std::memcpy(buffer, &raw, sizeof(raw));
+}
+
+/**
+ * @brief Load a value in network byte order from a possibly unaligned address
+ *
+ * @param buffer The source
+ * @return T The value in host byte order
+ */
+template <class T> inline T load(void const *buffer) {
+  static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                "only integers and enums have a wire format");
+  wire_type<T> raw;
+  std::memcpy(&raw, buffer, sizeof(raw));
+  if constexpr (sizeof(T) > 1) {
+    raw = ntoh(raw);
+  }
+  return static_cast<T>(raw);
+}
+
+/**
+ * @brief Store an array in network byte order, one value at a time. The
+ * buffers must not overlap. On big-endian hosts this is a plain copy.
+ *
+ * @param buffer The destination
+ * @param values The values
+ * @param count The number of values
+ */
+template <class T>
+inline void store_array(void *buffer, T const *__restrict values,
+                        size_t count) {
+  if constexpr (sizeof(T) == 1 || __BYTE_ORDER == __BIG_ENDIAN) {
+    std::memcpy(buffer, values, count * sizeof(T));
+  } else {
+    auto __restrict out = static_cast<char *>(buffer);
+    for (size_t i = 0; i < count; ++i) {
+      store(out + i * sizeof(T), values[i]);
+    }
+  }
+}
+
+/**
+ * @brief Load an array stored in network byte order, one value at a time.
+ * The buffers must not overlap.
+ *
+ * @param buffer The source
+ * @param values The destination values
+ * @param count The number of values
+ */
+template <class T>
+inline void load_array(void const *buffer, T *__restrict values,
+                       size_t count) {
+  if constexpr (sizeof(T) == 1 || __BYTE_ORDER == __BIG_ENDIAN) {
+    std::memcpy(values, buffer, count * sizeof(T));
+  } else {
+    auto __restrict in = static_cast<char const *>(buffer);
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = load<T>(in + i * sizeof(T));
+    }
+  }
+}
+
+/**
+ * @brief A fixed-size message of packed integer fields. Offsets are known at
+ * compile time, so single fields can be read and written in place.
+ *
+ * @tparam Fields The field types, in wire order
+ */
+template <class... Fields> struct flat_struct {
+  static constexpr size_t kSize = (sizeof(Fields) + ... + 0);
+
+  template <size_t I> static constexpr size_t offset() {
+    constexpr size_t sizes[] = {sizeof(Fields)..., 0};
+    size_t n = 0;
+    for (size_t i = 0; i < I; ++i) {
+      n += sizes[i];
+    }
+    return n;
+  }
+
+  template <size_t I>
+  using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+  template <size_t I> static field_type<I> get(void const *buffer) {
+    return load<field_type<I>>(static_cast<char const *>(buffer) +
+                               offset<I>());
+  }
+
+  template <size_t I>
+  static void set(void *buffer, field_type<I> const &value) {
+    store(static_cast<char *>(buffer) + offset<I>(), value);
+  }
+
+  static void pack(void *buffer, Fields const &...values) {
+    pack_fields(buffer, std::index_sequence_for<Fields...>{}, values...);
+  }
+
+  static std::tuple<Fields...> unpack(void const *buffer) {
+    return unpack_fields(buffer, std::index_sequence_for<Fields...>{});
+  }
+
+private:
+  template <size_t... I>
+  static void pack_fields(void *buffer, std::index_sequence<I...>,
+                          Fields const &...values) {
+    (set<I>(buffer, values), ...);
+  }
+
+  template <size_t... I>
+  static std::tuple<Fields...> unpack_fields(void const *buffer,
+                                             std::index_sequence<I...>) {
+    return std::tuple<Fields...>(get<I>(buffer)...);
+  }
+};
+
+/**
+ * @brief Writes a flat message straight into a caller-provided buffer, such as
+ * a registered send buffer. The caller sizes the buffer.
+ *
+ */
+class flat_writer {
+  char *begin_;
+  char *it_;
+
+public:
+  explicit flat_writer(void *buffer)
+      : begin_(static_cast<char *>(buffer)), it_(begin_) {}
+
+  template <class T> flat_writer &put(T const &value) {
+    store(it_, value);
+    it_ += sizeof(T);
+    return *this;
+  }
+
+  template <class T> flat_writer &put_array(T const *values, size_t count) {
+    store_array(it_, values, count);
+    it_ += count * sizeof(T);
+    return *this;
+  }
+
+  template <class Struct, class... Args>
+  flat_writer &put_struct(Args const &...values) {
+    Struct::pack(it_, values...);
+    it_ += Struct::kSize;
+    return *this;
+  }
+
+  flat_writer &put_bytes(void const *data, size_t length) {
+    std::memcpy(it_, data, length);
+    it_ += length;
+    return *this;
+  }
+
+  size_t size() const { return static_cast<size_t>(it_ - begin_); }
+};
+
+/**
+ * @brief Reads a flat message in place from a received buffer. Byte ranges are
+ * returned as pointers into the buffer instead of being copied. Every read is
+ * checked against the end of the buffer first. A read that does not fit
+ * returns zeros or nullptr, and the reader stays overrun from then on.
+ *
+ */
+class flat_reader {
+  char const *it_;
+  char const *end_;
+  bool overrun_;
+
+  /* Consumes length bytes, or marks the reader overrun if they do not fit */
+  bool take(size_t length) {
+    if (overrun_ || length > static_cast<size_t>(end_ - it_)) [[unlikely]] {
+      overrun_ = true;
+      return false;
+    }
+    return true;
+  }
+
+public:
+  flat_reader(void const *buffer, size_t length)
+      : it_(static_cast<char const *>(buffer)), end_(it_ + length),
+        overrun_(false) {}
+
+  template <class T> T get() {
+    if (!take(sizeof(T))) [[unlikely]] {
+      return T{};
+    }
+    auto value = load<T>(it_);
+    it_ += sizeof(T);
+    return value;
+  }
+
+  template <class T> void get_array(T *values, size_t count) {
+    /* Divides instead of multiplying, so a huge count cannot wrap */
+    if (overrun_ || count > remaining() / sizeof(T)) [[unlikely]] {
+      overrun_ = true;
+      std::fill_n(values, count, T{});
+      return;
+    }
+    load_array(it_, values, count);
+    it_ += count * sizeof(T);
+  }
+
+  template <class Struct> auto get_struct() {
+    if (!take(Struct::kSize)) [[unlikely]] {
+      return decltype(Struct::unpack(it_)){};
+    }
+    auto values = Struct::unpack(it_);
+    it_ += Struct::kSize;
+    return values;
+  }
+
+  char const *view(size_t length) {
+    if (!take(length)) [[unlikely]] {
+      return nullptr;
+    }
+    auto data = it_;
+    it_ += length;
+    return data;
+  }
+
+  size_t remaining() const {
+    return overrun_ ? 0 : static_cast<size_t>(end_ - it_);
+  }
+
+  bool overrun() const { return overrun_; }
+};
+
 } // namespace detail
 } // namespace ucxpp
\ No newline at end of file
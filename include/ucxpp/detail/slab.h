@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ucxpp/detail/noncopyable.h"
+
+namespace ucxpp {
+namespace detail {
+
+/**
+ * @brief Fixed-size object storage carved out of large chunks. Freed slots are
+ * kept on a free list and reused before a new chunk is allocated.
+ *
+ * @tparam T The object type stored in the slab
+ */
+template <class T> class slab : public noncopyable {
+  union slot {
+    slot *next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+  std::vector<std::unique_ptr<slot[]>> chunks_;
+  slot *free_;
+  size_t chunk_size_;
+  size_t allocated_;
+
+public:
+  slab(size_t chunk_size)
+      : free_(nullptr), chunk_size_(chunk_size == 0 ? 1 : chunk_size),
+        allocated_(0) {}
+
+  /**
+   * @brief Get uninitialized storage for one object
+   *
+   * @return void* The storage
+   */
+  void *allocate() {
+    if (free_ == nullptr) [[unlikely]] {
+      auto chunk = std::make_unique<slot[]>(chunk_size_);
+      for (size_t i = 0; i < chunk_size_; ++i) {
+        chunk[i].next = free_;
+        free_ = &chunk[i];
+      }
+      chunks_.push_back(std::move(chunk));
+    }
+    auto s = free_;
+    free_ = s->next;
+    ++allocated_;
+    return s->storage;
+  }
+
+  /**
+   * @brief Return storage obtained from allocate(). The object must have been
+   * destroyed already.
+   *
+   * @param p The storage
+   */
+  void deallocate(void *p) {
+    auto s = reinterpret_cast<slot *>(p);
+    s->next = free_;
+    free_ = s;
+    --allocated_;
+  }
+
+  /**
+   * @brief Get the number of slots in use
+   *
+   * @return size_t The number of slots in use
+   */
+  size_t size() const { return allocated_; }
+
+  /**
+   * @brief Get the number of slots allocated in all chunks
+   *
+   * @return size_t The number of slots allocated in all chunks
+   */
+  size_t capacity() const { return chunks_.size() * chunk_size_; }
+};
+
+} // namespace detail
+} // namespace ucxpp
\ No newline at end of file
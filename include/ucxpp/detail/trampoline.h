@@ -0,0 +1,84 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace ucxpp {
+namespace detail {
+
+/**
+ * @brief A tiny coroutine that calls a function every time it is resumed.
+ * Its handle lets a plain callback stand in for a suspended coroutine when
+ * handed to an awaitable. The function returns a coroutine to transfer to,
+ * which runs after the trampoline has parked again, so it may destroy the
+ * trampoline.
+ *
+ */
+class trampoline {
+public:
+  using function_type = std::coroutine_handle<> (*)(void *);
+
+  struct promise_type {
+    trampoline get_return_object() {
+      return trampoline(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_always final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+
+  trampoline() = default;
+
+  trampoline(trampoline &&other) : h_(std::exchange(other.h_, nullptr)) {}
+
+  trampoline &operator=(trampoline &&other) {
+    if (h_) {
+      h_.destroy();
+    }
+    h_ = std::exchange(other.h_, nullptr);
+    return *this;
+  }
+
+  /**
+   * @brief Create a parked trampoline
+   *
+   * @param fn The function to call on every resumption
+   * @param arg The argument of the function
+   * @return trampoline The trampoline
+   */
+  static trampoline make(function_type fn, void *arg) {
+    auto next = std::coroutine_handle<>(std::noop_coroutine());
+    while (true) {
+      co_await transfer{next};
+      next = fn(arg);
+    }
+  }
+
+  std::coroutine_handle<> handle() const { return h_; }
+
+  ~trampoline() {
+    if (h_) {
+      h_.destroy();
+    }
+  }
+
+private:
+  struct transfer {
+    std::coroutine_handle<> next;
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<>) noexcept {
+      return next;
+    }
+    void await_resume() const noexcept {}
+  };
+
+  explicit trampoline(std::coroutine_handle<promise_type> h) : h_(h) {}
+
+  std::coroutine_handle<promise_type> h_;
+};
+
+} // namespace detail
+} // namespace ucxpp
\ No newline at end of file
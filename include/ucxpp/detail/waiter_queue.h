@@ -0,0 +1,67 @@
+#pragma once
+
+#include <coroutine>
+
+namespace ucxpp {
+namespace detail {
+
+/**
+ * @brief A suspended coroutine linked into a waiter_queue. It is embedded in
+ * the awaitable, which lives in the coroutine frame, so queueing does not
+ * allocate.
+ *
+ */
+struct waiter {
+  waiter *next_ = nullptr;
+  std::coroutine_handle<> h_;
+};
+
+/**
+ * @brief Intrusive FIFO of waiters.
+ *
+ */
+class waiter_queue {
+  waiter *head_ = nullptr;
+  waiter *tail_ = nullptr;
+
+public:
+  bool empty() const { return head_ == nullptr; }
+
+  void push(waiter *w) {
+    w->next_ = nullptr;
+    if (tail_ != nullptr) {
+      tail_->next_ = w;
+    } else {
+      head_ = w;
+    }
+    tail_ = w;
+  }
+
+  waiter *front() const { return head_; }
+
+  waiter *pop() {
+    auto w = head_;
+    head_ = w->next_;
+    if (head_ == nullptr) {
+      tail_ = nullptr;
+    }
+    return w;
+  }
+
+  /* Moves all waiters to the back of the other queue */
+  void splice_to(waiter_queue &other) {
+    if (head_ == nullptr) {
+      return;
+    }
+    if (other.tail_ != nullptr) {
+      other.tail_->next_ = head_;
+    } else {
+      other.head_ = head_;
+    }
+    other.tail_ = tail_;
+    head_ = tail_ = nullptr;
+  }
+};
+
+} // namespace detail
+} // namespace ucxpp
\ No newline at end of file
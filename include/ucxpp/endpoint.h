@@ -10,8 +10,11 @@
 
 #include "ucxpp/address.h"
 #include "ucxpp/awaitable.h"
+#include "ucxpp/datatype.h"
 #include "ucxpp/error.h"
 #include "ucxpp/memory.h"
+#include "ucxpp/prepared.h"
+#include "ucxpp/rate_limiter.h"
 #include "ucxpp/task.h"
 #include "ucxpp/worker.h"
 
@@ -19,29 +22,153 @@
 
 namespace ucxpp {
 
+class endpoint_base;
+
 /**
- * @brief Abstraction for a UCX endpoint.
+ * @brief Called once when an endpoint fails or is destroyed, for operations
+ * on it that no UCX request completes, such as waiting for an RPC reply. It is
+ * embedded in the operation, so adding it does not allocate.
  *
  */
-class endpoint : public noncopyable,
-                 public std::enable_shared_from_this<endpoint> {
+class failure_hook : public noncopyable {
+  friend class endpoint_base;
+  void (*fn_)(void *, ucs_status_t);
+  void *arg_;
+  endpoint_base const *owner_;
+  failure_hook *prev_;
+  failure_hook *next_;
+
+public:
+  /**
+   * @brief Construct a new failure hook object
+   *
+   * @param fn Called with arg and the endpoint's error status, or
+   * UCS_ERR_NOT_CONNECTED if the endpoint is destroyed
+   * @param arg The argument of the function
+   */
+  failure_hook(void (*fn)(void *, ucs_status_t), void *arg)
+      : fn_(fn), arg_(arg), owner_(nullptr), prev_(nullptr), next_(nullptr) {}
+
+  /**
+   * @brief Remove the hook from its endpoint, if it was not called yet
+   *
+   */
+  void remove();
+
+  ~failure_hook() { remove(); }
+};
+
+/**
+ * @brief State shared by all endpoint flavors. Endpoints are linked into
+ * their worker so that the worker can close all of them at once.
+ *
+ */
+class endpoint_base : public noncopyable {
   friend class worker;
-  friend class local_memory_handle;
-  friend class remote_memory_handle;
+  friend class base_awaitable;
   friend class ep_close_awaitable;
-  std::shared_ptr<worker> worker_;
+  friend class ep_failure_awaitable;
+  friend class failure_hook;
+  friend class prepared_send;
+  friend class worker_close_all_awaitable;
+  endpoint_base *prev_;
+  endpoint_base *next_;
+  ucs_status_t status_;
+  bool track_inflight_;
+  mutable base_awaitable *inflight_;
+  ep_failure_awaitable *failure_waiters_;
+  mutable failure_hook *failure_hooks_;
+
+  void link_inflight(base_awaitable *awaitable) const;
+  void unlink_inflight(base_awaitable *awaitable) const;
+  void unlink_failure_hook(failure_hook &hook) const;
+  void call_failure_hooks(ucs_status_t status);
+
+  /**
+   * @brief Fail all tracked in-flight operations with the status, force close
+   * the endpoint, call the failure hooks and resume the on_failure() waiters
+   *
+   * @param status The error status
+   */
+  void fail(ucs_status_t status);
+
+protected:
   ucp_ep_h ep_;
   void *close_request_;
-  remote_address peer_;
 
-public:
+  endpoint_base();
+
   /**
-   * @brief Construct a new endpoint object
+   * @brief Create the UCX endpoint and link it into the worker
    *
    * @param worker UCX worker
-   * @param peer Remote UCX address
+   * @param address Remote UCX address, not referenced after this call
+   * @param err_mode UCP_ERR_HANDLING_MODE_PEER to detect peer failures and
+   * track in-flight operations
+   */
+  void open(worker &worker, ucp_address_t const *address,
+            ucp_err_handling_mode_t err_mode);
+
+  /**
+   * @brief Complete an operation at once with the endpoint's status if the
+   * endpoint is closed or failed, as nothing may be issued on it. Otherwise
+   * register it so that it fails with the endpoint's status if the endpoint
+   * fails while it is in flight, which is only done in peer error handling
+   * mode.
+   *
+   * @param awaitable The operation
+   */
+  void admit(base_awaitable &awaitable) const {
+    if (ep_ == nullptr) [[unlikely]] {
+      awaitable.status_ = status_ != UCS_OK ? status_ : UCS_ERR_NOT_CONNECTED;
+    } else if (track_inflight_) [[unlikely]] {
+      awaitable.owner_ = this;
+    }
+  }
+
+  /**
+   * @brief Admit an operation created on this endpoint
+   *
+   * @param awaitable The operation
+   * @return Awaitable The operation
    */
-  endpoint(std::shared_ptr<worker> worker, remote_address const &peer);
+  template <class Awaitable> Awaitable track(Awaitable awaitable) const {
+    admit(awaitable);
+    return awaitable;
+  }
+
+  /**
+   * @brief Unlink the endpoint from the worker and close it if it is not
+   * closed yet
+   *
+   * @param worker The worker passed to open()
+   */
+  void release(worker &worker);
+
+public:
+  /**
+   * @brief Get the endpoint's error status
+   *
+   * @return ucs_status_t UCS_OK if the endpoint has not failed
+   */
+  ucs_status_t status() const;
+
+  /**
+   * @brief Wait for the endpoint to fail. Useful for cancelling worker-level
+   * operations such as wildcard tag receives when a peer dies.
+   *
+   * @return ep_failure_awaitable A coroutine that returns the error status.
+   * It returns UCS_ERR_NOT_CONNECTED if the endpoint is destroyed first.
+   */
+  ep_failure_awaitable on_failure();
+
+  /**
+   * @brief Add a hook called when the endpoint fails or is destroyed. Failures
+   * are only detected in peer error handling mode.
+   *
+   * @param hook The hook, which must not be added to another endpoint
+   */
+  void add_failure_hook(failure_hook &hook) const;
 
   /**
    * @brief Error handler for all endpoints
@@ -52,6 +179,48 @@ public:
    */
   static void error_cb(void *ep, ucp_ep_h ep_h, ucs_status_t status);
 
+  /**
+   * @brief Endpoint close callback
+   *
+   * @param request UCX request handle
+   * @param status UCX status
+   * @param user_data User data
+   */
+  static void close_cb(void *request, ucs_status_t status, void *user_data);
+};
+
+/**
+ * @brief Abstraction for a UCX endpoint.
+ *
+ */
+class endpoint : public endpoint_base,
+                 public std::enable_shared_from_this<endpoint> {
+  friend class worker;
+  friend class local_memory_handle;
+  friend class remote_memory_handle;
+  std::shared_ptr<worker> worker_;
+  remote_address peer_;
+  std::unique_ptr<rate_limiter> rate_limiter_;
+
+  template <class Awaitable>
+  paced_awaitable<Awaitable> pace(size_t length, Awaitable awaitable) const {
+    return paced_awaitable<Awaitable>(rate_limiter_.get(),
+                                      worker_->rate_limiter_ptr(), length,
+                                      std::move(awaitable));
+  }
+
+public:
+  /**
+   * @brief Construct a new endpoint object
+   *
+   * @param worker UCX worker
+   * @param peer Remote UCX address
+   * @param err_mode UCP_ERR_HANDLING_MODE_PEER to detect peer failures and
+   * fail in-flight operations with the endpoint's status
+   */
+  endpoint(std::shared_ptr<worker> worker, remote_address const &peer,
+           ucp_err_handling_mode_t err_mode = UCP_ERR_HANDLING_MODE_NONE);
+
   /**
    * @brief Get the worker object
    *
@@ -88,6 +257,36 @@ public:
    */
   stream_send_awaitable stream_send(void const *buffer, size_t length) const;
 
+  /**
+   * @brief Prepare a stream send that is issued again on every start()
+   *
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param memh The memory handle of the buffer, or nullptr
+   * @return prepared_stream_send The prepared operation, which must not
+   * outlive the endpoint
+   */
+  prepared_stream_send prepare_stream_send(void const *buffer, size_t length,
+                                           ucp_mem_h memh = nullptr) const;
+
+  /**
+   * @brief Stream send the buffer with compile-time request attributes
+   *
+   * @tparam Policy An op_policy, e.g. op_policy<UCP_OP_ATTR_FLAG_FAST_CMPL>
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param memh The memory handle of the buffer, if the policy carries one
+   * @return basic_stream_send_awaitable<Policy> A coroutine that returns upon
+   * completion
+   */
+  template <class Policy>
+  basic_stream_send_awaitable<Policy>
+  stream_send(void const *buffer, size_t length,
+              ucp_mem_h memh = nullptr) const {
+    return track(basic_stream_send_awaitable<Policy>(
+        ep_, buffer, length, ucp_dt_make_contig(1), memh));
+  }
+
   /**
    * @brief Stream receive to the buffer
    *
@@ -109,6 +308,141 @@ public:
   tag_send_awaitable tag_send(void const *buffer, size_t length,
                               ucp_tag_t tag) const;
 
+  /**
+   * @brief Prepare a tag send that is issued again on every start(). The
+   * buffer is sent as it is at each start().
+   *
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param tag The tag to send with
+   * @param memh The memory handle of the buffer, or nullptr
+   * @return prepared_tag_send The prepared operation, which must not outlive
+   * the endpoint
+   */
+  prepared_tag_send prepare_tag_send(void const *buffer, size_t length,
+                                     ucp_tag_t tag,
+                                     ucp_mem_h memh = nullptr) const;
+
+  /**
+   * @brief Tag send the buffer with compile-time request attributes
+   *
+   * @tparam Policy An op_policy, e.g. op_policy<UCP_OP_ATTR_FLAG_FAST_CMPL>
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param tag The tag to send with
+   * @param memh The memory handle of the buffer, if the policy carries one
+   * @return basic_tag_send_awaitable<Policy> A coroutine that returns upon
+   * completion
+   */
+  template <class Policy>
+  basic_tag_send_awaitable<Policy> tag_send(void const *buffer, size_t length,
+                                            ucp_tag_t tag,
+                                            ucp_mem_h memh = nullptr) const {
+    return track(basic_tag_send_awaitable<Policy>(
+        ep_, buffer, length, tag, ucp_dt_make_contig(1), memh));
+  }
+
+  /**
+   * @brief Tag send an object, packed by UCX through pack_traits<T>
+   *
+   * @param object The object, which must stay valid until completion
+   * @param tag The tag to send with
+   * @return basic_tag_send_awaitable<datatype_op_policy> A coroutine that
+   * returns upon completion
+   */
+  template <class T>
+  basic_tag_send_awaitable<datatype_op_policy>
+  tag_send_object(T const &object, ucp_tag_t tag) const {
+    return track(basic_tag_send_awaitable<datatype_op_policy>(
+        ep_, &object, 1, tag, generic_datatype<T>::instance().handle()));
+  }
+
+  /**
+   * @brief Stream send an object, packed by UCX through pack_traits<T>
+   *
+   * @param object The object, which must stay valid until completion
+   * @return basic_stream_send_awaitable<datatype_op_policy> A coroutine that
+   * returns upon completion
+   */
+  template <class T>
+  basic_stream_send_awaitable<datatype_op_policy>
+  stream_send_object(T const &object) const {
+    return track(basic_stream_send_awaitable<datatype_op_policy>(
+        ep_, &object, 1, generic_datatype<T>::instance().handle()));
+  }
+
+  /**
+   * @brief Stream send a gather list as one operation, so that no other send
+   * on the endpoint lands between its buffers
+   *
+   * @param iov The buffers, which must stay valid until completion
+   * @param count The number of buffers
+   * @return basic_stream_send_awaitable<datatype_op_policy> A coroutine that
+   * returns upon completion
+   */
+  basic_stream_send_awaitable<datatype_op_policy>
+  stream_sendv(ucp_dt_iov_t const *iov, size_t count) const {
+    return track(basic_stream_send_awaitable<datatype_op_policy>(
+        ep_, iov, count, ucp_dt_make_iov()));
+  }
+
+  /**
+   * @brief Send an active message
+   *
+   * @param id The active message handler id
+   * @param header The header, which must stay valid until completion
+   * @param header_length The length of the header
+   * @param buffer The payload to send
+   * @param length The length of the payload
+   * @param flags UCP_AM_SEND_FLAG_* flags
+   * @return am_send_awaitable A coroutine that returns upon completion
+   */
+  am_send_awaitable am_send(unsigned id, void const *header,
+                            size_t header_length, void const *buffer,
+                            size_t length, uint32_t flags = 0) const;
+
+  /**
+   * @brief Limit the bytes per second of paced operations on this endpoint.
+   * The worker's limit, if any, applies as well.
+   *
+   * @param bytes_per_sec Sustained rate in bytes per second, 0 to remove the
+   * limit. Paced operations waiting for tokens are then admitted.
+   * @param burst Bucket size in bytes
+   */
+  void set_rate_limit(size_t bytes_per_sec, size_t burst);
+
+  /**
+   * @brief Get the endpoint's rate limiter
+   *
+   * @return rate_limiter* The endpoint's rate limiter, or null if there is none
+   */
+  rate_limiter *rate_limiter_ptr() const;
+
+  /**
+   * @brief Stream send the buffer once the endpoint's and the worker's rate
+   * limiters admit it
+   *
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @return paced_awaitable<stream_send_awaitable> A coroutine that returns
+   * upon completion
+   */
+  paced_awaitable<stream_send_awaitable>
+  paced_stream_send(void const *buffer, size_t length) const;
+
+  /**
+   * @brief Tag send the buffer once the endpoint's and the worker's rate
+   * limiters admit it
+   *
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param tag The tag to send with
+   * @return paced_awaitable<tag_send_awaitable> A coroutine that returns upon
+   * completion
+   */
+  paced_awaitable<tag_send_awaitable>
+  paced_tag_send(void const *buffer, size_t length, ucp_tag_t tag) const;
+
   /**
    * @brief Flush the endpoint
    *
@@ -124,15 +458,6 @@ public:
    */
   task<void> close();
 
-  /**
-   * @brief Endpoint close callback
-   *
-   * @param request UCX request handle
-   * @param status UCX status
-   * @param user_data User data
-   */
-  static void close_cb(void *request, ucs_status_t status, void *user_data);
-
   /**
    * @brief Destroy the endpoint object. If the endpoint is not closed yet, it
    * will be closed.
@@ -12,12 +12,13 @@ namespace ucxpp {
 
 constexpr size_t kErrorStringBufferSize = 1024;
 
-static inline void throw_with(const char *message) {
+[[noreturn]] static inline void throw_with(const char *message) {
   throw std::runtime_error(message);
 }
 
 template <class... Args>
-static inline void throw_with(const char *format, Args... args) {
+[[noreturn]] static inline void throw_with(const char *format,
+                                           Args... args) {
   char buffer[kErrorStringBufferSize];
   ::snprintf(buffer, sizeof(buffer), format, args...);
   throw std::runtime_error(buffer);
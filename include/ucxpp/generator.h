@@ -0,0 +1,141 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "ucxpp/detail/noncopyable.h"
+
+namespace ucxpp {
+
+/**
+ * @brief A lazy coroutine that yields a sequence of values asynchronously.
+ * The body runs only when the consumer awaits next(), and control passes
+ * between consumer and producer by symmetric transfer. Yielded values are
+ * handed out from the producer's frame, so no allocation is made per element.
+ * Yielded rvalues are moved to the consumer and yielded lvalues are copied,
+ * leaving the producer's variables intact.
+ *
+ * The generator may only be destroyed while it is suspended at a co_yield,
+ * before it started or after it finished.
+ *
+ * @tparam T The value type
+ */
+template <class T> class async_generator : public noncopyable {
+public:
+  struct promise_type {
+    T const *value_ = nullptr;
+    /* Only yielded rvalues are moved out, lvalues are copied */
+    bool movable_ = false;
+    std::coroutine_handle<> consumer_;
+    std::exception_ptr exception_;
+
+    /* Suspends the producer and resumes the consumer */
+    struct yield_awaiter {
+      bool await_ready() const noexcept { return false; }
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+        return h.promise().consumer_;
+      }
+      void await_resume() const noexcept {}
+    };
+
+    async_generator get_return_object() {
+      return async_generator(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    yield_awaiter final_suspend() const noexcept { return {}; }
+
+    /* The value outlives the suspension, as it is part of the full
+     * expression of co_yield */
+    yield_awaiter yield_value(T const &value) noexcept {
+      value_ = std::addressof(value);
+      movable_ = false;
+      return {};
+    }
+    yield_awaiter yield_value(T &&value) noexcept {
+      value_ = std::addressof(value);
+      movable_ = true;
+      return {};
+    }
+
+    void return_void() noexcept { value_ = nullptr; }
+    void unhandled_exception() noexcept {
+      value_ = nullptr;
+      exception_ = std::current_exception();
+    }
+  };
+
+  using coroutine_handle_type = std::coroutine_handle<promise_type>;
+
+  class next_awaitable {
+    coroutine_handle_type h_;
+
+  public:
+    explicit next_awaitable(coroutine_handle_type h) : h_(h) {}
+    bool await_ready() const noexcept { return !h_ || h_.done(); }
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<> consumer) noexcept {
+      h_.promise().consumer_ = consumer;
+      return h_;
+    }
+    std::optional<T> await_resume() {
+      if (!h_) [[unlikely]] {
+        return std::nullopt;
+      }
+      auto &promise = h_.promise();
+      if (promise.exception_) [[unlikely]] {
+        std::rethrow_exception(std::exchange(promise.exception_, nullptr));
+      }
+      if (h_.done()) {
+        return std::nullopt;
+      }
+      if (promise.movable_) {
+        return std::optional<T>(std::move(*const_cast<T *>(promise.value_)));
+      }
+      return std::optional<T>(*promise.value_);
+    }
+  };
+
+  explicit async_generator(coroutine_handle_type h) : h_(h) {}
+
+  async_generator(async_generator &&other)
+      : h_(std::exchange(other.h_, nullptr)) {}
+
+  async_generator &operator=(async_generator &&other) {
+    if (h_) {
+      h_.destroy();
+    }
+    h_ = std::exchange(other.h_, nullptr);
+    return *this;
+  }
+
+  /**
+   * @brief Resume the producer until it yields the next value or finishes
+   *
+   * @return next_awaitable A coroutine that returns the next value, or
+   * std::nullopt once the producer has finished
+   */
+  next_awaitable next() { return next_awaitable(h_); }
+
+  /**
+   * @brief Check whether the producer has finished
+   *
+   * @return true If the producer has finished
+   */
+  bool done() const { return !h_ || h_.done(); }
+
+  ~async_generator() {
+    if (h_) {
+      h_.destroy();
+    }
+  }
+
+private:
+  coroutine_handle_type h_;
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/recv_pool.h"
+#include "ucxpp/worker.h"
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/waiter_queue.h"
+
+namespace ucxpp {
+
+/**
+ * @brief Splits the 64-bit tag into prefix, channel, source and sequence
+ * fields, from the most significant bits down. The prefix takes the bits left
+ * over and tells mailbox traffic apart from other tags on the worker.
+ *
+ * @tparam ChannelBits Bits of the channel field
+ * @tparam SourceBits Bits of the source field
+ * @tparam SequenceBits Bits of the sequence field
+ */
+template <unsigned ChannelBits, unsigned SourceBits, unsigned SequenceBits>
+struct tag_layout {
+  static_assert(ChannelBits > 0 && ChannelBits <= 24,
+                "channels are looked up in a flat table");
+  static_assert(ChannelBits + SourceBits + SequenceBits <= 64,
+                "fields do not fit in a tag");
+
+  static constexpr unsigned kSequenceShift = 0;
+  static constexpr unsigned kSourceShift = SequenceBits;
+  static constexpr unsigned kChannelShift = SourceBits + SequenceBits;
+  static constexpr unsigned kPrefixShift = kChannelShift + ChannelBits;
+  static constexpr unsigned kPrefixBits = 64 - kPrefixShift;
+
+  static constexpr ucp_tag_t field_mask(unsigned bits) {
+    return bits >= 64 ? ~ucp_tag_t(0) : (ucp_tag_t(1) << bits) - 1;
+  }
+
+  /* Matches the prefix field only */
+  static constexpr ucp_tag_t kPrefixMask =
+      kPrefixBits == 0 ? 0 : field_mask(kPrefixBits) << kPrefixShift;
+
+  static constexpr size_t kMaxChannels = size_t(1) << ChannelBits;
+
+  static constexpr ucp_tag_t make(uint64_t prefix, uint64_t channel,
+                                  uint64_t source = 0, uint64_t sequence = 0) {
+    return (kPrefixBits == 0
+                ? 0
+                : (prefix & field_mask(kPrefixBits)) << kPrefixShift) |
+           (channel & field_mask(ChannelBits)) << kChannelShift |
+           (source & field_mask(SourceBits)) << kSourceShift |
+           (sequence & field_mask(SequenceBits)) << kSequenceShift;
+  }
+
+  static constexpr uint64_t prefix(ucp_tag_t tag) {
+    return kPrefixBits == 0 ? 0 : tag >> kPrefixShift;
+  }
+
+  static constexpr uint64_t channel(ucp_tag_t tag) {
+    return (tag >> kChannelShift) & field_mask(ChannelBits);
+  }
+
+  static constexpr uint64_t source(ucp_tag_t tag) {
+    return (tag >> kSourceShift) & field_mask(SourceBits);
+  }
+
+  static constexpr uint64_t sequence(ucp_tag_t tag) {
+    return (tag >> kSequenceShift) & field_mask(SequenceBits);
+  }
+};
+
+/**
+ * @brief Messages of one logical channel. Mailboxes live on one worker and
+ * are only touched from its progress thread, so they take no locks.
+ *
+ */
+class mailbox : public noncopyable {
+  worker *worker_;
+  std::deque<tag_recv_pool::buffer> messages_;
+  detail::waiter_queue waiters_;
+
+public:
+  class recv_awaitable : public detail::waiter {
+    friend class mailbox;
+    mailbox *mailbox_;
+    tag_recv_pool::buffer buffer_;
+
+  public:
+    recv_awaitable(mailbox *mailbox);
+    bool await_ready() noexcept;
+    void await_suspend(std::coroutine_handle<> h);
+    tag_recv_pool::buffer await_resume();
+  };
+
+  /**
+   * @brief Construct a new mailbox object
+   *
+   * @param worker The worker that resumes waiters
+   */
+  mailbox(worker &worker);
+
+  /**
+   * @brief Deliver a message to the mailbox
+   *
+   * @param buffer The received message
+   */
+  void push(tag_recv_pool::buffer buffer);
+
+  /**
+   * @brief Take the next message
+   *
+   * @return recv_awaitable A coroutine that returns the message
+   */
+  recv_awaitable recv();
+
+  /**
+   * @brief Get the number of queued messages
+   *
+   * @return size_t The number of queued messages
+   */
+  size_t size() const;
+};
+
+/**
+ * @brief Feeds per-channel mailboxes from one wildcard receive pool. Matching
+ * in UCX only sees the pool's receives, and a message is routed to its
+ * mailbox by a table lookup on the channel field.
+ *
+ * @tparam Layout A tag_layout
+ */
+template <class Layout> class mailbox_demux : public noncopyable {
+  std::shared_ptr<worker> worker_;
+  tag_recv_pool pool_;
+  std::vector<std::unique_ptr<mailbox>> mailboxes_;
+  size_t dropped_;
+
+  void dispatch(tag_recv_pool::buffer buffer) {
+    auto channel = Layout::channel(buffer.sender_tag());
+    if (channel < mailboxes_.size() && mailboxes_[channel]) [[likely]] {
+      mailboxes_[channel]->push(std::move(buffer));
+    } else {
+      ++dropped_;
+    }
+  }
+
+public:
+  /**
+   * @brief Construct a new mailbox demux object
+   *
+   * @param worker The worker to receive on
+   * @param prefix The prefix field of all mailbox tags
+   * @param buffer_size The largest message size
+   * @param depth The number of wildcard receives kept posted
+   */
+  mailbox_demux(std::shared_ptr<worker> worker, uint64_t prefix,
+                size_t buffer_size, size_t depth)
+      : worker_(worker),
+        pool_(worker, buffer_size, depth, Layout::make(prefix, 0),
+              Layout::kPrefixMask),
+        dropped_(0) {
+    pool_.on_receive(
+        [this](tag_recv_pool::buffer buffer) { dispatch(std::move(buffer)); });
+  }
+
+  /**
+   * @brief Get the mailbox of a channel, creating it on first use. Messages
+   * for channels that were never opened are dropped.
+   *
+   * @param channel The channel
+   * @return mailbox& The channel's mailbox
+   */
+  mailbox &open(uint64_t channel) {
+    channel &= Layout::kMaxChannels - 1;
+    if (channel >= mailboxes_.size()) {
+      mailboxes_.resize(channel + 1);
+    }
+    if (!mailboxes_[channel]) {
+      mailboxes_[channel] = std::make_unique<mailbox>(*worker_);
+    }
+    return *mailboxes_[channel];
+  }
+
+  /**
+   * @brief Get the number of messages dropped for unopened channels
+   *
+   * @return size_t The number of dropped messages
+   */
+  size_t dropped() const { return dropped_; }
+
+  ~mailbox_demux() {
+    /* Queued buffers go back to the pool before it cancels its receives */
+    pool_.on_receive(nullptr);
+    mailboxes_.clear();
+  }
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #include "ucxpp/awaitable.h"
 #include "ucxpp/context.h"
+#include "ucxpp/prepared.h"
+#include "ucxpp/rate_limiter.h"
 
 #include "ucxpp/detail/noncopyable.h"
 
@@ -97,9 +99,19 @@ public:
  */
 class remote_memory_handle : public noncopyable {
   std::shared_ptr<endpoint> endpoint_;
-  ucp_ep_h ep_;
   ucp_rkey_h rkey_;
 
+  /* The endpoint's current UCX handle, nullptr once it is closed or failed */
+  ucp_ep_h ep() const;
+
+  /* Completes the operation at once if the endpoint is closed or failed */
+  void admit(base_awaitable &awaitable) const;
+
+  template <class Awaitable> Awaitable track(Awaitable awaitable) const {
+    admit(awaitable);
+    return awaitable;
+  }
+
 public:
   /**
    * @brief Construct a new remote memory handle object. All subsequent remote
@@ -141,6 +153,62 @@ public:
   rma_get_awaitable get(void *buffer, size_t length,
                         uint64_t remote_addr) const;
 
+  /**
+   * @brief Prepare a write to the remote memory region that is issued again
+   * on every start()
+   *
+   * @param buffer Local buffer to write from
+   * @param length Length of the buffer
+   * @param remote_addr Remote address to write to
+   * @param memh The memory handle of the buffer, or nullptr
+   * @return prepared_rma_put The prepared operation, which must not outlive
+   * this handle
+   */
+  prepared_rma_put prepare_put(void const *buffer, size_t length,
+                               uint64_t remote_addr,
+                               ucp_mem_h memh = nullptr) const;
+
+  /**
+   * @brief Prepare a read from the remote memory region that is issued again
+   * on every start()
+   *
+   * @param buffer Local buffer to read into
+   * @param length Length of the buffer
+   * @param remote_addr Remote address to read from
+   * @param memh The memory handle of the buffer, or nullptr
+   * @return prepared_rma_get The prepared operation, which must not outlive
+   * this handle
+   */
+  prepared_rma_get prepare_get(void *buffer, size_t length,
+                               uint64_t remote_addr,
+                               ucp_mem_h memh = nullptr) const;
+
+  /**
+   * @brief Write to the remote memory region once the endpoint's and the
+   * worker's rate limiters admit it
+   *
+   * @param buffer Local buffer to write from
+   * @param length Length of the buffer
+   * @param remote_addr Remote address to write to
+   * @return paced_awaitable<rma_put_awaitable> A coroutine that returns upon
+   * completion
+   */
+  paced_awaitable<rma_put_awaitable>
+  paced_put(void const *buffer, size_t length, uint64_t remote_addr) const;
+
+  /**
+   * @brief Read from the remote memory region once the endpoint's and the
+   * worker's rate limiters admit it
+   *
+   * @param buffer Local buffer to read into
+   * @param length Length of the buffer
+   * @param remote_addr Remote address to read from
+   * @return paced_awaitable<rma_get_awaitable> A coroutine that returns upon
+   * completion
+   */
+  paced_awaitable<rma_get_awaitable>
+  paced_get(void *buffer, size_t length, uint64_t remote_addr) const;
+
   /**
    * \copydoc endpoint::put
    *
@@ -177,14 +245,14 @@ public:
    * @param remote_addr The remote address to add to
    * @param delta The value to add
    * @param old_value A reference to a variable to store the old value
-   * @return rma_atomic_awaitable<T> A coroutine that returns upon completion.
-   * The old value is placed in old_value
+   * @return rma_atomic_awaitable<T, true> A coroutine that returns upon
+   * completion. The old value is placed in old_value
    */
   template <class T>
-  rma_atomic_awaitable<T> atomic_fetch_add(uint64_t remote_addr, T const &delta,
-                                           T &old_value) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_ADD, &delta, remote_addr,
-                                   rkey_, &old_value);
+  rma_atomic_awaitable<T, true>
+  atomic_fetch_add(uint64_t remote_addr, T const &delta, T &old_value) const {
+    return track(rma_atomic_awaitable<T, true>(
+        ep(), UCP_ATOMIC_OP_ADD, &delta, remote_addr, rkey_, &old_value));
   }
 
   /**
@@ -195,14 +263,14 @@ public:
    * @param remote_addr The remote address to AND to
    * @param delta The other operand of the AND operation
    * @param old_value A reference to a variable to store the old value
-   * @return rma_atomic_awaitable<T> A coroutine that returns upon completion.
-   * The old value is placed in old_value
+   * @return rma_atomic_awaitable<T, true> A coroutine that returns upon
+   * completion. The old value is placed in old_value
    */
   template <class T>
-  rma_atomic_awaitable<T> atomic_fetch_and(uint64_t remote_addr, T const &bits,
-                                           T &old_value) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_AND, &bits, remote_addr,
-                                   rkey_, &old_value);
+  rma_atomic_awaitable<T, true>
+  atomic_fetch_and(uint64_t remote_addr, T const &bits, T &old_value) const {
+    return track(rma_atomic_awaitable<T, true>(
+        ep(), UCP_ATOMIC_OP_AND, &bits, remote_addr, rkey_, &old_value));
   }
 
   /**
@@ -213,14 +281,14 @@ public:
    * @param remote_addr The remote address to OR to
    * @param delta The other operand of the OR operation
    * @param old_value A reference to a variable to store the old value
-   * @return rma_atomic_awaitable<T> A coroutine that returns upon completion.
-   * The old value is placed in old_value
+   * @return rma_atomic_awaitable<T, true> A coroutine that returns upon
+   * completion. The old value is placed in old_value
    */
   template <class T>
-  rma_atomic_awaitable<T> atomic_fetch_or(uint64_t remote_addr, T const &bits,
-                                          T &old_value) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_OR, &bits, remote_addr,
-                                   rkey_, &old_value);
+  rma_atomic_awaitable<T, true>
+  atomic_fetch_or(uint64_t remote_addr, T const &bits, T &old_value) const {
+    return track(rma_atomic_awaitable<T, true>(
+        ep(), UCP_ATOMIC_OP_OR, &bits, remote_addr, rkey_, &old_value));
   }
 
   /**
@@ -231,14 +299,14 @@ public:
    * @param remote_addr The remote address to XOR to
    * @param delta The other operand of the XOR operation
    * @param old_value A reference to a variable to store the old value
-   * @return rma_atomic_awaitable<T> A coroutine that returns upon completion.
-   * The old value is placed in old_value
+   * @return rma_atomic_awaitable<T, true> A coroutine that returns upon
+   * completion. The old value is placed in old_value
    */
   template <class T>
-  rma_atomic_awaitable<T> atomic_fetch_xor(uint64_t remote_addr, T const &bits,
-                                           T &old_value) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_XOR, &bits, remote_addr,
-                                   rkey_, &old_value);
+  rma_atomic_awaitable<T, true>
+  atomic_fetch_xor(uint64_t remote_addr, T const &bits, T &old_value) const {
+    return track(rma_atomic_awaitable<T, true>(
+        ep(), UCP_ATOMIC_OP_XOR, &bits, remote_addr, rkey_, &old_value));
   }
 
   /**
@@ -253,8 +321,8 @@ public:
   template <class T>
   rma_atomic_awaitable<T> atomic_add(uint64_t remote_addr,
                                      T const &delta) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_ADD, &delta, remote_addr,
-                                   rkey_);
+    return track(rma_atomic_awaitable<T>(ep(), UCP_ATOMIC_OP_ADD, &delta,
+                                         remote_addr, rkey_));
   }
 
   /**
@@ -269,8 +337,8 @@ public:
   template <class T>
   rma_atomic_awaitable<T> atomic_and(uint64_t remote_addr,
                                      T const &bits) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_AND, &bits, remote_addr,
-                                   rkey_);
+    return track(rma_atomic_awaitable<T>(ep(), UCP_ATOMIC_OP_AND, &bits,
+                                         remote_addr, rkey_));
   }
 
   /**
@@ -283,8 +351,8 @@ public:
    */
   template <class T>
   rma_atomic_awaitable<T> atomic_or(uint64_t remote_addr, T const &bits) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_OR, &bits, remote_addr,
-                                   rkey_);
+    return track(rma_atomic_awaitable<T>(ep(), UCP_ATOMIC_OP_OR, &bits,
+                                         remote_addr, rkey_));
   }
 
   /**
@@ -300,8 +368,8 @@ public:
   template <class T>
   rma_atomic_awaitable<T> atomic_xor(uint64_t remote_addr,
                                      T const &bits) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_XOR, &bits, remote_addr,
-                                   rkey_);
+    return track(rma_atomic_awaitable<T>(ep(), UCP_ATOMIC_OP_XOR, &bits,
+                                         remote_addr, rkey_));
   }
 
   /**
@@ -312,14 +380,14 @@ public:
    * @param remote_addr The remote address to swap
    * @param new_value The new value to swap in
    * @param old_value A reference to a variable to store the old value
-   * @return rma_atomic_awaitable<T> A coroutine that returns upon completion.
-   * The old value is placed in old_value
+   * @return rma_atomic_awaitable<T, true> A coroutine that returns upon
+   * completion. The old value is placed in old_value
    */
   template <class T>
-  rma_atomic_awaitable<T> atomic_swap(uint64_t remote_addr, T const &new_value,
-                                      T &old_value) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_SWAP, &new_value,
-                                   remote_addr, rkey_, &old_value);
+  rma_atomic_awaitable<T, true>
+  atomic_swap(uint64_t remote_addr, T const &new_value, T &old_value) const {
+    return track(rma_atomic_awaitable<T, true>(
+        ep(), UCP_ATOMIC_OP_SWAP, &new_value, remote_addr, rkey_, &old_value));
   }
 
   /**
@@ -331,14 +399,15 @@ public:
    * @param expected The expected value to compare against
    * @param desired_and_old A reference to a variable to store the desired new
    * value and the old value swapped out
-   * @return rma_atomic_awaitable<T> A coroutine that returns upon completion.
-   * The old value is placed in desired_and_old
+   * @return rma_atomic_awaitable<T, true> A coroutine that returns upon
+   * completion. The old value is placed in desired_and_old
    */
   template <class T>
-  rma_atomic_awaitable<T> atomic_compare_swap(uint64_t raddr, T const &expected,
-                                              T &desired_and_old) const {
-    return rma_atomic_awaitable<T>(ep_, UCP_ATOMIC_OP_CSWAP, &expected, raddr,
-                                   rkey_, &desired_and_old);
+  rma_atomic_awaitable<T, true>
+  atomic_compare_swap(uint64_t raddr, T const &expected,
+                      T &desired_and_old) const {
+    return track(rma_atomic_awaitable<T, true>(
+        ep(), UCP_ATOMIC_OP_CSWAP, &expected, raddr, rkey_, &desired_and_old));
   }
 
   /**
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ucxpp/task.h"
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/trampoline.h"
+
+namespace ucxpp {
+
+/**
+ * @brief Keeps up to depth operations in flight from a single coroutine.
+ * Operations are stored in a fixed ring of slots, and each slot owns a
+ * trampoline that records the completion in place of a suspended coroutine,
+ * so no coroutine frame is created per operation. Results of operations are
+ * discarded, and a failed operation throws when its slot is reaped.
+ *
+ * @tparam Awaitable The operation type, e.g. tag_send_awaitable
+ */
+template <class Awaitable> class pipeline : public noncopyable {
+  struct slot {
+    pipeline *owner;
+    std::optional<Awaitable> op;
+    bool done;
+    detail::trampoline resume;
+  };
+
+  std::unique_ptr<slot[]> slots_;
+  std::vector<size_t> order_;
+  std::vector<size_t> free_;
+  size_t head_;
+  size_t size_;
+  size_t completed_;
+  std::coroutine_handle<> waiter_;
+  bool wait_any_;
+
+  static std::coroutine_handle<> on_complete(void *arg) {
+    auto s = static_cast<slot *>(arg);
+    s->done = true;
+    return s->owner->notify();
+  }
+
+  std::coroutine_handle<> notify() {
+    ++completed_;
+    if (waiter_ && (wait_any_ || oldest().done)) {
+      return std::exchange(waiter_, nullptr);
+    }
+    return std::noop_coroutine();
+  }
+
+  slot &oldest() { return slots_[order_[head_]]; }
+
+  void start(Awaitable &&op) {
+    auto index = free_.back();
+    free_.pop_back();
+    order_[(head_ + size_) % order_.size()] = index;
+    ++size_;
+    auto &s = slots_[index];
+    s.done = false;
+    s.op.emplace(std::move(op));
+    if (s.op->await_ready()) {
+      s.done = true;
+      ++completed_;
+      return;
+    }
+    using result_type =
+        decltype(s.op->await_suspend(std::declval<std::coroutine_handle<>>()));
+    if constexpr (std::is_same_v<result_type, bool>) {
+      if (!s.op->await_suspend(s.resume.handle())) {
+        s.done = true;
+        ++completed_;
+      }
+    } else {
+      s.op->await_suspend(s.resume.handle());
+    }
+  }
+
+  /* Frees the slot at position pos of the issue order */
+  void reap(size_t pos) {
+    auto n = order_.size();
+    auto index = order_[(head_ + pos) % n];
+    for (size_t i = pos; i > 0; --i) {
+      order_[(head_ + i) % n] = order_[(head_ + i - 1) % n];
+    }
+    head_ = (head_ + 1) % n;
+    --size_;
+    --completed_;
+    free_.push_back(index);
+    auto &s = slots_[index];
+    auto op = std::move(*s.op);
+    s.op.reset();
+    op.await_resume();
+  }
+
+  bool find_done(size_t &pos) {
+    for (pos = 0; pos < size_; ++pos) {
+      if (slots_[order_[(head_ + pos) % order_.size()]].done) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+public:
+  class submit_awaitable {
+    pipeline *pipeline_;
+    Awaitable op_;
+    bool started_;
+
+  public:
+    submit_awaitable(pipeline *pipeline, Awaitable op)
+        : pipeline_(pipeline), op_(std::move(op)), started_(false) {}
+
+    bool await_ready() {
+      auto p = pipeline_;
+      if (p->size_ < p->order_.size()) {
+        started_ = true;
+        p->start(std::move(op_));
+        return true;
+      }
+      if (p->oldest().done) {
+        started_ = true;
+        p->reap(0);
+        p->start(std::move(op_));
+        return true;
+      }
+      return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+      pipeline_->waiter_ = h;
+      pipeline_->wait_any_ = false;
+    }
+
+    void await_resume() {
+      if (started_) {
+        return;
+      }
+      /* Resumed by the completion of the oldest operation */
+      started_ = true;
+      pipeline_->reap(0);
+      pipeline_->start(std::move(op_));
+    }
+  };
+
+  class wait_awaitable {
+    pipeline *pipeline_;
+    bool any_;
+    bool empty_;
+
+  public:
+    wait_awaitable(pipeline *pipeline, bool any)
+        : pipeline_(pipeline), any_(any), empty_(false) {}
+
+    bool await_ready() {
+      auto p = pipeline_;
+      if (p->size_ == 0) {
+        empty_ = true;
+        return true;
+      }
+      return any_ ? p->completed_ > 0 : p->oldest().done;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+      pipeline_->waiter_ = h;
+      pipeline_->wait_any_ = any_;
+    }
+
+    void await_resume() {
+      if (empty_) {
+        return;
+      }
+      size_t pos = 0;
+      if (any_) {
+        pipeline_->find_done(pos);
+      }
+      pipeline_->reap(pos);
+    }
+  };
+
+  /**
+   * @brief Construct a new pipeline object
+   *
+   * @param depth The largest number of operations in flight
+   */
+  explicit pipeline(size_t depth)
+      : slots_(std::make_unique<slot[]>(depth == 0 ? 1 : depth)),
+        order_(depth == 0 ? 1 : depth), head_(0), size_(0), completed_(0),
+        wait_any_(false) {
+    free_.reserve(order_.size());
+    for (size_t i = order_.size(); i > 0; --i) {
+      auto &s = slots_[i - 1];
+      s.owner = this;
+      s.done = false;
+      s.resume = detail::trampoline::make(&on_complete, &s);
+      free_.push_back(i - 1);
+    }
+  }
+
+  /**
+   * @brief Issue an operation. When depth operations are outstanding, the
+   * oldest is waited for and reaped first.
+   *
+   * @param op The operation, not yet awaited
+   * @return submit_awaitable A coroutine that returns once the operation is
+   * issued, and throws if a reaped operation failed
+   */
+  submit_awaitable submit(Awaitable op) {
+    return submit_awaitable(this, std::move(op));
+  }
+
+  /**
+   * @brief Wait for the oldest outstanding operation and reap it
+   *
+   * @return wait_awaitable A coroutine that returns when the oldest operation
+   * completes, and throws if it failed
+   */
+  wait_awaitable wait_oldest() { return wait_awaitable(this, false); }
+
+  /**
+   * @brief Wait for any outstanding operation and reap it
+   *
+   * @return wait_awaitable A coroutine that returns when an operation
+   * completes, and throws if it failed
+   */
+  wait_awaitable wait_any() { return wait_awaitable(this, true); }
+
+  /**
+   * @brief Wait for all outstanding operations
+   *
+   * @return task<void> A coroutine that returns when no operation is
+   * outstanding, and throws on the first failed one
+   */
+  task<void> drain() {
+    while (size_ > 0) {
+      co_await wait_oldest();
+    }
+  }
+
+  /**
+   * @brief Get the number of outstanding operations, including completed ones
+   * that are not reaped yet
+   *
+   * @return size_t The number of outstanding operations
+   */
+  size_t outstanding() const { return size_; }
+
+  /**
+   * @brief Get the depth of the pipeline
+   *
+   * @return size_t The depth
+   */
+  size_t depth() const { return order_.size(); }
+
+  /**
+   * @brief Destroy the pipeline object. No operation may be outstanding.
+   *
+   */
+  ~pipeline() { assert(size_ == 0); }
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/awaitable.h"
+#include "ucxpp/completion.h"
+#include "ucxpp/error.h"
+
+namespace ucxpp {
+
+class endpoint_base;
+
+/**
+ * @brief Common state of prepared send-like operations. The arguments and the
+ * request parameters are filled in once, and every start() issues the same
+ * operation again, like an MPI persistent request. Only one submission may be
+ * in flight at a time, and the object may not move, as UCX calls back into
+ * it. Several prepared operations may be started before any is awaited.
+ *
+ */
+class prepared_send : public base_awaitable {
+protected:
+  endpoint_base const *endpoint_;
+  ucp_request_param_t param_;
+
+  prepared_send(endpoint_base const &endpoint, ucp_mem_h memh);
+
+  /* Returns the UCX endpoint, or nullptr after failing the submission if the
+   * endpoint is closed or failed */
+  ucp_ep_h admit();
+
+  /* Records the outcome of issuing the operation, and links a request still
+   * in flight into the endpoint right away, as start() and co_await are
+   * separate */
+  void issued(ucs_status_ptr_t request);
+
+public:
+  prepared_send(prepared_send const &) = delete;
+  prepared_send &operator=(prepared_send const &) = delete;
+
+  /* Called through the completion layer when the request completes. The
+   * request may complete before any coroutine awaits this submission, in
+   * which case only the status is recorded. */
+  void on_complete(ucs_status_t status);
+
+  bool await_ready() const noexcept { return status_ != UCS_INPROGRESS; }
+
+  void await_suspend(std::coroutine_handle<> h) { h_ = h; }
+
+  void await_resume() const { check_ucs_status(status_, "operation failed"); }
+};
+
+class prepared_stream_send : public prepared_send {
+  void const *buffer_;
+  size_t length_;
+
+public:
+  /**
+   * @brief Prepare a stream send
+   *
+   * @param endpoint The endpoint to send to
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param memh The memory handle of the buffer, or nullptr
+   */
+  prepared_stream_send(endpoint_base const &endpoint, void const *buffer,
+                       size_t length, ucp_mem_h memh = nullptr);
+
+  /**
+   * @brief Issue the send. Await this object for its completion.
+   *
+   */
+  void start();
+};
+
+class prepared_tag_send : public prepared_send {
+  void const *buffer_;
+  size_t length_;
+  ucp_tag_t tag_;
+
+public:
+  /**
+   * @brief Prepare a tag send
+   *
+   * @param endpoint The endpoint to send to
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param tag The tag to send with
+   * @param memh The memory handle of the buffer, or nullptr
+   */
+  prepared_tag_send(endpoint_base const &endpoint, void const *buffer,
+                    size_t length, ucp_tag_t tag, ucp_mem_h memh = nullptr);
+
+  /**
+   * @brief Issue the send. Await this object for its completion.
+   *
+   */
+  void start();
+};
+
+class prepared_rma_put : public prepared_send {
+  void const *buffer_;
+  size_t length_;
+  uint64_t remote_addr_;
+  ucp_rkey_h rkey_;
+
+public:
+  /**
+   * @brief Prepare an RMA write
+   *
+   * @param endpoint The endpoint the rkey was unpacked on
+   * @param buffer Local buffer to write from
+   * @param length Length of the buffer
+   * @param remote_addr Remote address to write to
+   * @param rkey The unpacked remote key, which must outlive this object
+   * @param memh The memory handle of the buffer, or nullptr
+   */
+  prepared_rma_put(endpoint_base const &endpoint, void const *buffer,
+                   size_t length, uint64_t remote_addr, ucp_rkey_h rkey,
+                   ucp_mem_h memh = nullptr);
+
+  /**
+   * @brief Issue the write. Await this object for its completion.
+   *
+   */
+  void start();
+};
+
+class prepared_rma_get : public prepared_send {
+  void *buffer_;
+  size_t length_;
+  uint64_t remote_addr_;
+  ucp_rkey_h rkey_;
+
+public:
+  /**
+   * @brief Prepare an RMA read
+   *
+   * @param endpoint The endpoint the rkey was unpacked on
+   * @param buffer Local buffer to read into
+   * @param length Length of the buffer
+   * @param remote_addr Remote address to read from
+   * @param rkey The unpacked remote key, which must outlive this object
+   * @param memh The memory handle of the buffer, or nullptr
+   */
+  prepared_rma_get(endpoint_base const &endpoint, void *buffer, size_t length,
+                   uint64_t remote_addr, ucp_rkey_h rkey,
+                   ucp_mem_h memh = nullptr);
+
+  /**
+   * @brief Issue the read. Await this object for its completion.
+   *
+   */
+  void start();
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/endpoint.h"
+#include "ucxpp/task.h"
+#include "ucxpp/worker.h"
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/waiter_queue.h"
+
+namespace ucxpp {
+
+/* Active message id of published messages */
+constexpr unsigned kPubSubDefaultAmId = 0x42;
+
+/**
+ * @brief A k-ary relay tree over an ordered member list. Member 0 is the
+ * publisher, and member i forwards to members i * fanout + 1 to
+ * i * fanout + fanout.
+ *
+ */
+struct relay_tree {
+  /**
+   * @brief Get the children of a member
+   *
+   * @param index The member index
+   * @param members The number of members, including the publisher
+   * @param fanout The number of children per member
+   * @return std::vector<size_t> The child indices
+   */
+  static std::vector<size_t> children(size_t index, size_t members,
+                                      size_t fanout);
+
+  /**
+   * @brief Get the parent of a member other than the publisher
+   *
+   * @param index The member index
+   * @param fanout The number of children per member
+   * @return size_t The parent index
+   */
+  static size_t parent(size_t index, size_t fanout);
+};
+
+/**
+ * @brief A publish/subscribe node. A published message is sent to the topic's
+ * subscriber endpoints only, and nodes that receive it deliver it locally and
+ * relay it to their own subscribers. Arranging nodes in a relay_tree bounds
+ * the sends of every node by the fanout. Messages of topics a node neither
+ * subscribes to nor relays are dropped.
+ *
+ */
+class pubsub_node : public noncopyable {
+public:
+  /* A received message, shared by local delivery and relaying */
+  using message = std::shared_ptr<std::vector<char> const>;
+
+  /* Sends one buffer to a set of endpoints and returns the failed count */
+  class fanout_awaitable {
+    unsigned am_id_;
+    std::vector<std::shared_ptr<endpoint>> const *targets_;
+    void const *data_;
+    size_t length_;
+    std::array<char, sizeof(uint64_t)> header_;
+    size_t pending_;
+    size_t failed_;
+    std::coroutine_handle<> h_;
+
+    static void send_cb(void *request, ucs_status_t status, void *user_data);
+
+  public:
+    fanout_awaitable(unsigned am_id,
+                     std::vector<std::shared_ptr<endpoint>> const &targets,
+                     uint64_t topic, void const *data, size_t length);
+    bool await_ready() noexcept;
+    bool await_suspend(std::coroutine_handle<> h);
+    size_t await_resume() const;
+  };
+
+  class recv_awaitable : public detail::waiter {
+    friend class pubsub_node;
+    pubsub_node *node_;
+    uint64_t topic_;
+    message message_;
+
+  public:
+    recv_awaitable(pubsub_node *node, uint64_t topic);
+    bool await_ready() noexcept;
+    void await_suspend(std::coroutine_handle<> h);
+    message await_resume();
+  };
+
+private:
+  struct topic_state {
+    std::vector<std::shared_ptr<endpoint>> subscribers;
+    bool local = false;
+    std::deque<message> messages;
+    detail::waiter_queue waiters;
+  };
+
+  std::shared_ptr<worker> worker_;
+  unsigned am_id_;
+  std::unordered_map<uint64_t, topic_state> topics_;
+
+  static ucs_status_t am_cb(void *arg, void const *header,
+                            size_t header_length, void *data, size_t length,
+                            ucp_am_recv_param_t const *param);
+  static task<void> receive(pubsub_node *node, uint64_t topic,
+                            std::shared_ptr<std::vector<char>> buffer,
+                            void *rndv_desc);
+  static task<void> relay(pubsub_node *node, uint64_t topic, message msg);
+  void dispatch(uint64_t topic, message msg);
+
+public:
+  /**
+   * @brief Construct a new pubsub node object. The worker's context must have
+   * the AM feature enabled.
+   *
+   * @param worker The worker to receive and relay messages on
+   * @param am_id The active message id of published messages
+   */
+  pubsub_node(std::shared_ptr<worker> worker,
+              unsigned am_id = kPubSubDefaultAmId);
+
+  /**
+   * @brief Add a subscriber endpoint, which receives every message of the
+   * topic published or relayed by this node
+   *
+   * @param topic The topic
+   * @param ep The endpoint to the subscriber
+   */
+  void add_subscriber(uint64_t topic, std::shared_ptr<endpoint> ep);
+
+  /**
+   * @brief Remove a subscriber endpoint
+   *
+   * @param topic The topic
+   * @param ep The endpoint to the subscriber
+   */
+  void remove_subscriber(uint64_t topic, endpoint const &ep);
+
+  /**
+   * @brief Get the number of subscriber endpoints of a topic
+   *
+   * @param topic The topic
+   * @return size_t The number of subscriber endpoints
+   */
+  size_t subscribers(uint64_t topic) const;
+
+  /**
+   * @brief Deliver messages of a topic to recv() on this node. Messages of
+   * other topics are only relayed.
+   *
+   * @param topic The topic
+   */
+  void subscribe(uint64_t topic);
+
+  /**
+   * @brief Take the next message of a subscribed topic
+   *
+   * @param topic The topic
+   * @return recv_awaitable A coroutine that returns the message
+   */
+  recv_awaitable recv(uint64_t topic);
+
+  /**
+   * @brief Publish a message to the topic's subscriber endpoints. Every send
+   * reads the same buffer, which must stay valid until completion.
+   *
+   * @param topic The topic
+   * @param data The payload
+   * @param length The length of the payload
+   * @return fanout_awaitable A coroutine that returns the number of
+   * subscribers the send failed to
+   */
+  fanout_awaitable publish(uint64_t topic, void const *data, size_t length);
+
+  /**
+   * @brief Destroy the pubsub node object and remove its handler from the
+   * worker. Relays in flight must have completed.
+   *
+   */
+  ~pubsub_node();
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/address.h"
+#include "ucxpp/awaitable.h"
+#include "ucxpp/endpoint.h"
+#include "ucxpp/task.h"
+#include "ucxpp/worker.h"
+
+#include "ucxpp/detail/noncopyable.h"
+
+namespace ucxpp {
+
+/**
+ * @brief Traffic classes with separate endpoints and optionally separate
+ * workers.
+ *
+ */
+enum class traffic_class {
+  latency = 0,
+  bulk = 1,
+};
+
+class qos_scheduler;
+
+/* Counts a latency-class operation as in flight until it resumes */
+template <class Awaitable> class latency_op {
+  qos_scheduler *scheduler_;
+  Awaitable inner_;
+
+public:
+  latency_op(qos_scheduler *scheduler, Awaitable inner)
+      : scheduler_(scheduler), inner_(std::move(inner)) {}
+
+  bool await_ready() noexcept;
+
+  auto await_suspend(std::coroutine_handle<> h) {
+    return inner_.await_suspend(h);
+  }
+
+  decltype(auto) await_resume();
+};
+
+/* Suspends bulk submission while latency-class operations are in flight */
+class bulk_admission_awaitable {
+  friend class qos_scheduler;
+  qos_scheduler *scheduler_;
+  bulk_admission_awaitable *next_;
+  std::coroutine_handle<> h_;
+
+public:
+  bulk_admission_awaitable(qos_scheduler *scheduler);
+  bool await_ready() noexcept;
+  void await_suspend(std::coroutine_handle<> h);
+  void await_resume() const {}
+};
+
+/**
+ * @brief Progresses the latency-class worker ahead of the bulk-class worker
+ * and gates bulk submission on latency-class operations.
+ *
+ */
+class qos_scheduler : public noncopyable {
+  template <class Awaitable> friend class latency_op;
+  friend class bulk_admission_awaitable;
+  std::shared_ptr<worker> workers_[2];
+  size_t latency_inflight_;
+  size_t latency_budget_;
+  bool pause_bulk_;
+  bulk_admission_awaitable *waiters_head_;
+  bulk_admission_awaitable *waiters_tail_;
+
+  bool bulk_admissible() const;
+
+public:
+  /**
+   * @brief Construct a new qos scheduler object
+   *
+   * @param latency_worker Worker for latency-class traffic
+   * @param bulk_worker Worker for bulk-class traffic. If null, the latency
+   * worker is shared by both classes.
+   * @param latency_budget Maximum number of latency worker progress calls in
+   * one progress() before the bulk worker gets a turn
+   */
+  qos_scheduler(std::shared_ptr<worker> latency_worker,
+                std::shared_ptr<worker> bulk_worker = nullptr,
+                size_t latency_budget = 16);
+
+  /**
+   * @brief Get the worker of a traffic class
+   *
+   * @param cls The traffic class
+   * @return std::shared_ptr<worker> The worker of the class
+   */
+  std::shared_ptr<worker> worker_ptr(traffic_class cls) const;
+
+  /**
+   * @brief Pause bulk admission while latency-class operations are in flight
+   *
+   * @param pause Whether to pause bulk admission
+   */
+  void set_pause_bulk(bool pause);
+
+  /**
+   * @brief Get the number of latency-class operations in flight
+   *
+   * @return size_t The number of latency-class operations in flight
+   */
+  size_t latency_inflight() const;
+
+  /**
+   * @brief Progress the latency worker until it is idle or the budget is
+   * used, then progress the bulk worker once and admit waiting bulk
+   * submitters.
+   *
+   * @return true If progress was made
+   * @return false If no progress was made
+   */
+  bool progress();
+
+  /**
+   * @brief Wait until bulk submission is allowed
+   *
+   * @return bulk_admission_awaitable A coroutine that returns when bulk
+   * operations may be submitted
+   */
+  bulk_admission_awaitable admit_bulk();
+
+  /**
+   * @brief Count an operation as latency-class while it is in flight
+   *
+   * @param op The operation
+   * @return latency_op<Awaitable> A coroutine that returns the operation's
+   * result
+   */
+  template <class Awaitable> latency_op<Awaitable> latency(Awaitable op) {
+    return latency_op<Awaitable>(this, std::move(op));
+  }
+};
+
+template <class Awaitable> bool latency_op<Awaitable>::await_ready() noexcept {
+  ++scheduler_->latency_inflight_;
+  return inner_.await_ready();
+}
+
+template <class Awaitable>
+decltype(auto) latency_op<Awaitable>::await_resume() {
+  --scheduler_->latency_inflight_;
+  return inner_.await_resume();
+}
+
+/**
+ * @brief A peer reached through one endpoint per traffic class.
+ *
+ */
+class qos_endpoint : public noncopyable {
+  std::shared_ptr<qos_scheduler> scheduler_;
+  std::shared_ptr<endpoint> endpoints_[2];
+
+public:
+  /**
+   * @brief Construct a new qos endpoint object
+   *
+   * @param scheduler The scheduler owning the class workers
+   * @param latency_peer Remote address for latency-class traffic
+   * @param bulk_peer Remote address for bulk-class traffic
+   * @param err_mode Error handling mode of both endpoints
+   */
+  qos_endpoint(std::shared_ptr<qos_scheduler> scheduler,
+               remote_address const &latency_peer,
+               remote_address const &bulk_peer,
+               ucp_err_handling_mode_t err_mode = UCP_ERR_HANDLING_MODE_NONE);
+
+  /**
+   * @brief Construct a new qos endpoint object to a peer with one worker
+   *
+   * @param scheduler The scheduler owning the class workers
+   * @param peer Remote address for both classes
+   * @param err_mode Error handling mode of both endpoints
+   */
+  qos_endpoint(std::shared_ptr<qos_scheduler> scheduler,
+               remote_address const &peer,
+               ucp_err_handling_mode_t err_mode = UCP_ERR_HANDLING_MODE_NONE);
+
+  /**
+   * @brief Get the endpoint of a traffic class
+   *
+   * @param cls The traffic class
+   * @return std::shared_ptr<endpoint> The endpoint of the class
+   */
+  std::shared_ptr<endpoint> endpoint_ptr(traffic_class cls) const;
+
+  /**
+   * @brief Tag send the buffer as latency-class traffic
+   *
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param tag The tag to send with
+   * @return latency_op<tag_send_awaitable> A coroutine that returns upon
+   * completion
+   */
+  latency_op<tag_send_awaitable> tag_send(void const *buffer, size_t length,
+                                          ucp_tag_t tag) const;
+
+  /**
+   * @brief Stream send the buffer as latency-class traffic
+   *
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @return latency_op<stream_send_awaitable> A coroutine that returns upon
+   * completion
+   */
+  latency_op<stream_send_awaitable> stream_send(void const *buffer,
+                                                size_t length) const;
+
+  /**
+   * @brief Tag send the buffer as bulk-class traffic once admitted
+   *
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @param tag The tag to send with
+   * @return task<void> A coroutine that returns upon completion
+   */
+  task<void> bulk_tag_send(void const *buffer, size_t length,
+                           ucp_tag_t tag) const;
+
+  /**
+   * @brief Stream send the buffer as bulk-class traffic once admitted
+   *
+   * @param buffer The buffer to send
+   * @param length The length of the buffer
+   * @return task<void> A coroutine that returns upon completion
+   */
+  task<void> bulk_stream_send(void const *buffer, size_t length) const;
+};
+
+} // namespace ucxpp
\ No newline at end of file
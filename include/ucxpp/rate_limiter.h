@@ -0,0 +1,187 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <utility>
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/waiter_queue.h"
+
+namespace ucxpp {
+
+class worker;
+class rate_limiter;
+
+/* Suspends until the limiter has tokens for the requested bytes */
+class rate_limit_awaitable : public detail::waiter {
+  friend class rate_limiter;
+
+protected:
+  rate_limiter *limiter_;
+  size_t bytes_;
+  /* Called by the limiter instead of resuming the waiter when admitted */
+  void (*admitted_)(rate_limit_awaitable *);
+
+public:
+  rate_limit_awaitable(rate_limiter *limiter, size_t bytes);
+  bool await_ready() noexcept;
+  void await_suspend(std::coroutine_handle<> h);
+  void await_resume() const {}
+};
+
+/**
+ * @brief A token bucket in bytes. Acquirers are admitted in FIFO order and
+ * waiting acquirers are admitted by the worker's progress(), which resumes
+ * them after all limiters are polled. While acquirers wait, worker::arm()
+ * fails, so event loops keep polling instead of sleeping past the refill. A
+ * request larger than the burst size is admitted when the bucket is full and
+ * leaves it in debt.
+ *
+ */
+class rate_limiter : public noncopyable {
+  friend class worker;
+  friend class rate_limit_awaitable;
+  using clock = std::chrono::steady_clock;
+  worker *worker_;
+  double bytes_per_sec_;
+  double burst_;
+  double tokens_;
+  clock::time_point last_refill_;
+  detail::waiter_queue waiters_;
+  rate_limiter *prev_;
+  rate_limiter *next_;
+  bool linked_;
+  template <class Awaitable> friend class paced_awaitable;
+
+  void refill();
+  bool try_take(size_t bytes);
+  void link();
+  void unlink();
+
+  /* Takes tokens at once if no acquirer is waiting ahead */
+  bool admit_now(size_t bytes);
+  void enqueue(rate_limit_awaitable *waiter);
+  void post(detail::waiter *waiter);
+
+public:
+  /**
+   * @brief Construct a new rate limiter object. The bucket starts full.
+   *
+   * @param worker The worker whose progress() admits waiting acquirers
+   * @param bytes_per_sec Sustained rate in bytes per second, or 0 to admit
+   * everything at once
+   * @param burst Bucket size in bytes
+   */
+  rate_limiter(worker &worker, size_t bytes_per_sec, size_t burst);
+
+  /**
+   * @brief Change the rate and the burst size
+   *
+   * @param bytes_per_sec Sustained rate in bytes per second, or 0 to admit
+   * everything at once, including the acquirers already waiting
+   * @param burst Bucket size in bytes
+   */
+  void set_rate(size_t bytes_per_sec, size_t burst);
+
+  /**
+   * @brief Take tokens for the given number of bytes
+   *
+   * @param bytes The number of bytes about to be transferred
+   * @return rate_limit_awaitable A coroutine that returns when the bytes are
+   * admitted
+   */
+  rate_limit_awaitable acquire(size_t bytes);
+
+  /**
+   * @brief Refill the bucket and admit waiting acquirers. Admitted coroutines
+   * are posted to the worker rather than resumed here.
+   *
+   * @return true If any acquirer was admitted
+   * @return false If no acquirer was admitted
+   */
+  bool poll();
+
+  /**
+   * @brief Destroy the rate limiter object. No acquirer may be waiting.
+   *
+   */
+  ~rate_limiter();
+};
+
+/**
+ * @brief Passes up to two rate limiters and then issues an operation, without
+ * allocating. Each limiter admits the operation in turn from its poll(), and
+ * the awaiting coroutine is resumed only when the operation completes.
+ *
+ * @tparam Awaitable The operation's awaitable
+ */
+template <class Awaitable> class paced_awaitable : public rate_limit_awaitable {
+  rate_limiter *second_;
+  Awaitable inner_;
+  bool issued_;
+
+  /* Takes the remaining limiters that admit at once, stopping at the first
+   * one that must be waited on */
+  bool pass() {
+    while (limiter_ != nullptr) {
+      if (!limiter_->admit_now(bytes_)) {
+        return false;
+      }
+      limiter_ = std::exchange(second_, nullptr);
+    }
+    return true;
+  }
+
+  static void on_admitted(rate_limit_awaitable *waiter) {
+    auto self = static_cast<paced_awaitable *>(waiter);
+    auto limiter = self->limiter_;
+    self->limiter_ = std::exchange(self->second_, nullptr);
+    if (!self->pass()) {
+      self->limiter_->enqueue(self);
+      return;
+    }
+    self->issued_ = true;
+    if (self->inner_.await_ready() || !self->inner_.await_suspend(self->h_)) {
+      limiter->post(self);
+    }
+  }
+
+public:
+  /**
+   * @brief Construct a new paced awaitable object
+   *
+   * @param first The first limiter to pass, or nullptr
+   * @param second The second limiter to pass, or nullptr
+   * @param bytes The number of bytes to take from each limiter
+   * @param inner The operation to issue once admitted
+   */
+  paced_awaitable(rate_limiter *first, rate_limiter *second, size_t bytes,
+                  Awaitable inner)
+      : rate_limit_awaitable(first != nullptr ? first : second, bytes),
+        second_(first != nullptr ? second : nullptr),
+        inner_(std::move(inner)), issued_(false) {
+    admitted_ = &on_admitted;
+  }
+
+  bool await_ready() noexcept {
+    if (!pass()) {
+      return false;
+    }
+    issued_ = true;
+    return inner_.await_ready();
+  }
+
+  bool await_suspend(std::coroutine_handle<> h) {
+    h_ = h;
+    if (!issued_) {
+      limiter_->enqueue(this);
+      return true;
+    }
+    return inner_.await_suspend(h);
+  }
+
+  decltype(auto) await_resume() { return inner_.await_resume(); }
+};
+
+} // namespace ucxpp
\ No newline at end of file
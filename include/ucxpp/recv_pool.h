@@ -0,0 +1,188 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/generator.h"
+#include "ucxpp/memory.h"
+#include "ucxpp/worker.h"
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/waiter_queue.h"
+
+namespace ucxpp {
+
+/**
+ * @brief Keeps a fixed number of tag receives posted for each size class, so
+ * that messages land in expected receives. Buffers come from per-class slabs
+ * of registered memory. Completed receives are handed to consumers in arrival
+ * order and a replacement receive is posted right away. Senders pick the size
+ * class through the tag.
+ *
+ */
+class tag_recv_pool : public noncopyable {
+public:
+  /**
+   * @brief Receives of one buffer size for one tag range. Buffers are
+   * registered in chunks of depth buffers, and a new chunk is added when all
+   * buffers are held by consumers or queued for them. Once the class has
+   * max_chunks chunks, it stops reposting until buffers are returned, and
+   * further messages wait in UCX as unexpected ones.
+   *
+   */
+  struct size_class {
+    size_t size;
+    size_t depth;
+    ucp_tag_t tag;
+    ucp_tag_t tag_mask = 0xFFFFFFFFFFFFFFFF;
+    size_t max_chunks = 4;
+  };
+
+  class buffer;
+
+private:
+  struct class_state;
+
+  struct slot {
+    tag_recv_pool *pool;
+    class_state *cls;
+    char *data;
+    void *request;
+    size_t length;
+    ucp_tag_t sender_tag;
+    ucs_status_t status;
+    slot *next;
+  };
+
+  struct class_state {
+    size_class config;
+    std::vector<local_memory_handle> mrs;
+    std::vector<std::unique_ptr<slot[]>> slots;
+    slot *free;
+    size_t posted;
+    /* Fewer than depth receives are posted for lack of buffers */
+    bool starved;
+  };
+
+  std::shared_ptr<worker> worker_;
+  std::vector<class_state> classes_;
+  slot *ready_head_;
+  slot *ready_tail_;
+  detail::waiter_queue waiters_;
+  std::function<void(buffer)> handler_;
+  size_t posted_;
+  bool closed_;
+
+  static void recv_cb(void *request, ucs_status_t status,
+                      ucp_tag_recv_info_t const *info, void *user_data);
+  void grow(class_state &cls);
+  void fill(class_state &cls);
+  void deliver(slot *s);
+  void release(slot *s);
+
+public:
+  /**
+   * @brief A received message. The buffer goes back to the pool when this
+   * object is destroyed.
+   *
+   */
+  class buffer : public noncopyable {
+    friend class tag_recv_pool;
+    slot *slot_;
+
+    explicit buffer(slot *s);
+
+  public:
+    /* An empty buffer */
+    buffer();
+    buffer(buffer &&other);
+    buffer &operator=(buffer &&other);
+    void const *data() const;
+    void *data();
+    size_t length() const;
+    ucp_tag_t sender_tag() const;
+    ~buffer();
+  };
+
+  class recv_awaitable : public detail::waiter {
+    friend class tag_recv_pool;
+    tag_recv_pool *pool_;
+    slot *slot_;
+
+  public:
+    recv_awaitable(tag_recv_pool *pool);
+    bool await_ready() noexcept;
+    void await_suspend(std::coroutine_handle<> h);
+    buffer await_resume();
+  };
+
+  /**
+   * @brief Construct a new tag receive pool object and post the receives
+   *
+   * @param worker The worker to post receives on
+   * @param classes The size classes. Their tag ranges should not overlap.
+   */
+  tag_recv_pool(std::shared_ptr<worker> worker,
+                std::vector<size_class> const &classes);
+
+  /**
+   * @brief Construct a new tag receive pool object with a single size class
+   *
+   * @param worker The worker to post receives on
+   * @param size The buffer size
+   * @param depth The number of receives kept posted
+   * @param tag The tag to receive with
+   * @param tag_mask The bit mask for tag matching
+   * @param max_chunks The number of chunks of depth buffers the pool may
+   * register
+   */
+  tag_recv_pool(std::shared_ptr<worker> worker, size_t size, size_t depth,
+                ucp_tag_t tag, ucp_tag_t tag_mask = 0xFFFFFFFFFFFFFFFF,
+                size_t max_chunks = 4);
+
+  /**
+   * @brief Take the next received message
+   *
+   * @return recv_awaitable A coroutine that returns the received buffer
+   */
+  recv_awaitable recv();
+
+  /**
+   * @brief Yield received messages one after another
+   *
+   * @return async_generator<buffer> A generator of received buffers
+   */
+  async_generator<buffer> messages();
+
+  /**
+   * @brief Hand successfully received buffers to a handler instead of recv()
+   * consumers. Buffers already queued for recv() are handed over at once.
+   * The handler runs in the receive completion callback and must not resume
+   * coroutines directly.
+   *
+   * @param handler The handler, or an empty function to go back to recv()
+   */
+  void on_receive(std::function<void(buffer)> handler);
+
+  /**
+   * @brief Get the number of receives currently posted
+   *
+   * @return size_t The number of receives posted
+   */
+  size_t posted() const;
+
+  /**
+   * @brief Cancel the posted receives and progress the worker until they are
+   * released. All buffers must have been returned and no consumer may be
+   * waiting.
+   *
+   */
+  ~tag_recv_pool();
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/endpoint.h"
+#include "ucxpp/task.h"
+#include "ucxpp/worker.h"
+
+#include "ucxpp/detail/noncopyable.h"
+
+namespace ucxpp {
+
+/* Request header: method, status and request id in network byte order */
+constexpr size_t kRpcHeaderSize = 16;
+
+/* Requests use this active message id and replies use the next one */
+constexpr unsigned kRpcDefaultAmId = 0x40;
+
+using rpc_payload = std::vector<char>;
+
+/**
+ * @brief An RPC method. It receives the request payload and returns the reply
+ * payload.
+ *
+ */
+using rpc_handler = std::function<task<rpc_payload>(rpc_payload)>;
+
+/**
+ * @brief Serves RPC requests arriving on a worker. Each request runs its
+ * handler as a coroutine and the result is sent back on the reply endpoint.
+ * Payloads at or above the zero-copy threshold are sent with rendezvous.
+ *
+ */
+class rpc_server : public noncopyable {
+  std::shared_ptr<worker> worker_;
+  unsigned am_id_;
+  size_t zcopy_threshold_;
+  std::unordered_map<uint32_t, rpc_handler> handlers_;
+
+  static ucs_status_t request_cb(void *arg, void const *header,
+                                 size_t header_length, void *data,
+                                 size_t length,
+                                 ucp_am_recv_param_t const *param);
+  static task<void> serve(rpc_server *server, ucp_ep_h reply_ep,
+                          uint32_t method, uint64_t request_id,
+                          rpc_payload args, void *rndv_desc);
+
+public:
+  /**
+   * @brief Construct a new rpc server object. The worker's context must have
+   * the AM feature enabled.
+   *
+   * @param worker The worker to receive requests on
+   * @param am_id The active message id of requests. Replies use am_id + 1.
+   * @param zcopy_threshold Reply size from which rendezvous is forced
+   */
+  rpc_server(std::shared_ptr<worker> worker, unsigned am_id = kRpcDefaultAmId,
+             size_t zcopy_threshold = 8192);
+
+  /**
+   * @brief Register a method. Requests for unknown methods fail with
+   * UCS_ERR_UNSUPPORTED, and handlers that throw fail with UCS_ERR_IO_ERROR.
+   *
+   * @param method The method id
+   * @param handler The coroutine serving the method
+   */
+  void register_method(uint32_t method, rpc_handler handler);
+
+  /**
+   * @brief Destroy the rpc server object and remove its handler from the
+   * worker. Requests being served must have completed.
+   *
+   */
+  ~rpc_server();
+};
+
+class rpc_client;
+
+/*
+ * An RPC call, resumed when both the request is sent and the reply arrived,
+ * or when the endpoint fails or is destroyed before the reply
+ */
+class rpc_call_awaitable {
+  friend class rpc_client;
+  rpc_client *client_;
+  endpoint const *endpoint_;
+  uint32_t method_;
+  void const *args_;
+  size_t length_;
+  uint32_t slot_;
+  unsigned pending_;
+  bool replied_;
+  ucs_status_t status_;
+  std::coroutine_handle<> h_;
+  std::array<char, kRpcHeaderSize> header_;
+  rpc_payload reply_;
+  failure_hook hook_;
+
+  static void send_cb(void *request, ucs_status_t status, void *user_data);
+  static void on_failure(void *arg, ucs_status_t status);
+  void complete_one();
+
+public:
+  rpc_call_awaitable(rpc_client *client, endpoint const &ep, uint32_t method,
+                     void const *args, size_t length);
+  bool await_ready() noexcept;
+  bool await_suspend(std::coroutine_handle<> h);
+  rpc_payload await_resume();
+};
+
+/**
+ * @brief Issues RPC calls from a worker. In-flight calls are kept in a table
+ * indexed by request id, and a reply resumes its caller directly.
+ *
+ */
+class rpc_client : public noncopyable {
+  friend class rpc_call_awaitable;
+  struct pending_call {
+    rpc_call_awaitable *call;
+    uint32_t generation;
+    uint32_t next_free;
+  };
+
+  std::shared_ptr<worker> worker_;
+  unsigned am_id_;
+  size_t zcopy_threshold_;
+  std::vector<pending_call> calls_;
+  uint32_t free_;
+
+  uint64_t acquire_slot(rpc_call_awaitable *call);
+  void release_slot(uint32_t slot);
+  static ucs_status_t reply_cb(void *arg, void const *header,
+                               size_t header_length, void *data, size_t length,
+                               ucp_am_recv_param_t const *param);
+  static task<void> receive_reply(ucp_worker_h worker, void *rndv_desc,
+                                  rpc_call_awaitable *call);
+
+public:
+  /**
+   * @brief Construct a new rpc client object. The worker's context must have
+   * the AM feature enabled.
+   *
+   * @param worker The worker to issue calls from
+   * @param am_id The active message id of requests. Replies use am_id + 1.
+   * @param zcopy_threshold Argument size from which rendezvous is forced
+   */
+  rpc_client(std::shared_ptr<worker> worker, unsigned am_id = kRpcDefaultAmId,
+             size_t zcopy_threshold = 8192);
+
+  /**
+   * @brief Call a remote method. The arguments are not copied and must stay
+   * valid until the call returns. The call fails with the endpoint's status
+   * if the endpoint is closed, fails in peer error handling mode, or is
+   * destroyed before the reply arrives. Without peer error handling, a call
+   * to a dead server never returns.
+   *
+   * @param ep The endpoint to the server, created on this client's worker
+   * @param method The method id
+   * @param args The request payload
+   * @param length The length of the request payload
+   * @return rpc_call_awaitable A coroutine that returns the reply payload
+   */
+  rpc_call_awaitable call(endpoint const &ep, uint32_t method,
+                          void const *args, size_t length);
+
+  /**
+   * @brief Get the number of calls in flight
+   *
+   * @return size_t The number of calls in flight
+   */
+  size_t in_flight() const;
+
+  /**
+   * @brief Destroy the rpc client object and remove its handler from the
+   * worker. No call may be in flight.
+   *
+   */
+  ~rpc_client();
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "ucxpp/endpoint.h"
+#include "ucxpp/generator.h"
+#include "ucxpp/memory.h"
+#include "ucxpp/task.h"
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/waiter_queue.h"
+
+namespace ucxpp {
+
+/**
+ * @brief Writes length-framed messages to an endpoint's stream. Frames are
+ * copied into registered segments and a segment is sent when it is full or on
+ * flush(), so small writes are coalesced into few stream sends. Each frame is
+ * prefixed with its length as a 32-bit integer in network byte order.
+ *
+ */
+class stream_writer : public noncopyable {
+  struct segment {
+    char *buffer;
+    size_t used;
+    bool in_flight;
+  };
+
+  /* Resumed by the worker after a segment send completes */
+  class idle_awaitable : public detail::waiter {
+    stream_writer *writer_;
+
+  public:
+    idle_awaitable(stream_writer *writer) : writer_(writer) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const {}
+  };
+
+  std::shared_ptr<endpoint> endpoint_;
+  size_t capacity_;
+  std::vector<local_memory_handle> mrs_;
+  std::vector<segment> segments_;
+  size_t current_;
+  detail::waiter_queue waiters_;
+  std::exception_ptr error_;
+
+  segment *seal();
+  task<void> send_segment(segment *s);
+  static void check_length(size_t length);
+
+public:
+  /**
+   * @brief Length prefix of each frame
+   *
+   */
+  using length_type = uint32_t;
+
+  /**
+   * @brief Construct a new stream writer object
+   *
+   * @param endpoint The endpoint to write to
+   * @param capacity Size of each registered segment
+   * @param depth Number of segments, bounding the sends in flight
+   */
+  stream_writer(std::shared_ptr<endpoint> endpoint, size_t capacity = 65536,
+                size_t depth = 2);
+
+  /**
+   * @brief Append a frame without waiting. The frame is copied.
+   *
+   * @param data The frame payload
+   * @param length The length of the payload
+   * @return true If the frame was appended
+   * @return false If the frame does not fit in a segment, or all segments are
+   * in flight. It throws if the length does not fit the length prefix.
+   */
+  bool try_write(void const *data, size_t length);
+
+  /**
+   * @brief Append a frame, waiting for a free segment if needed. Frames larger
+   * than a segment are sent directly from the caller's buffer, which must then
+   * stay valid until the returned coroutine completes.
+   *
+   * @param data The frame payload
+   * @param length The length of the payload
+   * @return task<void> A coroutine that returns when the frame is appended.
+   * It throws if the length does not fit the length prefix.
+   */
+  task<void> write(void const *data, size_t length);
+
+  /**
+   * @brief Send the buffered frames and wait for all segments to be sent
+   *
+   * @return task<void> A coroutine that returns when all frames are sent
+   */
+  task<void> flush();
+
+  /**
+   * @brief Get the number of segments in flight
+   *
+   * @return size_t The number of segments in flight
+   */
+  size_t in_flight() const;
+
+  /**
+   * @brief Destroy the stream writer object. Unflushed frames are dropped and
+   * no segment may be in flight.
+   *
+   */
+  ~stream_writer();
+};
+
+/**
+ * @brief Reads length-framed messages written by a stream_writer. It receives
+ * into a registered buffer with reads as large as the free space, so a batch
+ * of frames usually arrives in one stream receive.
+ *
+ */
+class stream_reader : public noncopyable {
+public:
+  /* Returns a buffered frame without suspending, and receives otherwise */
+  class frame_awaitable {
+    stream_reader *reader_;
+    std::optional<task<void>> fill_;
+    std::span<char const> frame_;
+
+  public:
+    explicit frame_awaitable(stream_reader *reader) : reader_(reader) {}
+    bool await_ready();
+    bool await_suspend(std::coroutine_handle<> h);
+    std::span<char const> await_resume();
+  };
+
+private:
+  std::shared_ptr<endpoint> endpoint_;
+  std::optional<local_memory_handle> mr_;
+  char *buffer_;
+  size_t capacity_;
+  size_t max_frame_;
+  size_t begin_;
+  size_t end_;
+
+  task<void> fill(size_t length);
+  task<void> fill_frame();
+  size_t frame_length() const;
+  bool take_frame(std::span<char const> &frame);
+
+public:
+  /**
+   * @brief Construct a new stream reader object
+   *
+   * @param endpoint The endpoint to read from
+   * @param capacity Initial size of the registered buffer. It grows to fit
+   * larger frames.
+   * @param max_frame The largest frame payload accepted from the peer, which
+   * bounds how far the buffer grows
+   */
+  stream_reader(std::shared_ptr<endpoint> endpoint, size_t capacity = 65536,
+                size_t max_frame = 64 << 20);
+
+  /**
+   * @brief Read the next frame. A frame that is already buffered is returned
+   * without suspending or allocating.
+   *
+   * @return frame_awaitable A coroutine that returns the frame payload, which
+   * stays valid until the next read. It throws if the frame is larger than
+   * max_frame, after which the stream cannot be read further.
+   */
+  frame_awaitable read_frame();
+
+  /**
+   * @brief Read unframed bytes
+   *
+   * @param length The number of bytes
+   * @return task<std::span<char const>> A coroutine that returns the bytes,
+   * which stay valid until the next read
+   */
+  task<std::span<char const>> read(size_t length);
+
+  /**
+   * @brief Yield frames one after another. Each frame stays valid until the
+   * next one is pulled.
+   *
+   * @return async_generator<std::span<char const>> A generator of frames
+   */
+  async_generator<std::span<char const>> frames();
+
+  /**
+   * @brief Get the number of received bytes not read yet
+   *
+   * @return size_t The number of buffered bytes
+   */
+  size_t buffered() const;
+};
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,345 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "ucxpp/worker.h"
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/waiter_queue.h"
+
+namespace ucxpp {
+
+/**
+ * @brief A mutex for coroutines on one worker. Ownership is handed to the
+ * next waiter on unlock(), and the waiter is resumed by the worker's
+ * progress().
+ *
+ */
+class async_mutex : public noncopyable {
+  worker *worker_;
+  bool locked_;
+  detail::waiter_queue waiters_;
+
+public:
+  class lock_awaitable : public detail::waiter {
+    async_mutex *mutex_;
+
+  public:
+    lock_awaitable(async_mutex *mutex) : mutex_(mutex) {}
+    bool await_ready() noexcept;
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const {}
+  };
+
+  /**
+   * @brief Construct a new async mutex object
+   *
+   * @param worker The worker that resumes waiters
+   */
+  async_mutex(worker &worker);
+
+  /**
+   * @brief Lock the mutex
+   *
+   * @return lock_awaitable A coroutine that returns when the mutex is locked
+   */
+  lock_awaitable lock();
+
+  /**
+   * @brief Lock the mutex if it is not locked
+   *
+   * @return true If the mutex was locked
+   * @return false If the mutex is held by another coroutine
+   */
+  bool try_lock();
+
+  /**
+   * @brief Unlock the mutex
+   *
+   */
+  void unlock();
+};
+
+/**
+ * @brief A counting semaphore for coroutines on one worker. Useful for
+ * limiting the number of requests in flight.
+ *
+ */
+class async_semaphore : public noncopyable {
+  worker *worker_;
+  size_t count_;
+  detail::waiter_queue waiters_;
+
+public:
+  class acquire_awaitable : public detail::waiter {
+    async_semaphore *semaphore_;
+
+  public:
+    acquire_awaitable(async_semaphore *semaphore) : semaphore_(semaphore) {}
+    bool await_ready() noexcept;
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const {}
+  };
+
+  /**
+   * @brief Construct a new async semaphore object
+   *
+   * @param worker The worker that resumes waiters
+   * @param count The initial count
+   */
+  async_semaphore(worker &worker, size_t count);
+
+  /**
+   * @brief Decrement the count, waiting while it is zero
+   *
+   * @return acquire_awaitable A coroutine that returns upon acquisition
+   */
+  acquire_awaitable acquire();
+
+  /**
+   * @brief Decrement the count if it is not zero
+   *
+   * @return true If the semaphore was acquired
+   * @return false If the count is zero
+   */
+  bool try_acquire();
+
+  /**
+   * @brief Increment the count, waking up to n waiters
+   *
+   * @param n The number to add to the count
+   */
+  void release(size_t n = 1);
+
+  /**
+   * @brief Get the current count
+   *
+   * @return size_t The current count
+   */
+  size_t count() const;
+};
+
+/**
+ * @brief A manual-reset event for coroutines on one worker.
+ *
+ */
+class async_event : public noncopyable {
+  worker *worker_;
+  bool set_;
+  detail::waiter_queue waiters_;
+
+public:
+  class wait_awaitable : public detail::waiter {
+    async_event *event_;
+
+  public:
+    wait_awaitable(async_event *event) : event_(event) {}
+    bool await_ready() noexcept;
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const {}
+  };
+
+  /**
+   * @brief Construct a new async event object
+   *
+   * @param worker The worker that resumes waiters
+   * @param set Whether the event starts set
+   */
+  async_event(worker &worker, bool set = false);
+
+  /**
+   * @brief Wait for the event to be set
+   *
+   * @return wait_awaitable A coroutine that returns when the event is set
+   */
+  wait_awaitable wait();
+
+  /**
+   * @brief Set the event and wake up all waiters
+   *
+   */
+  void set();
+
+  /**
+   * @brief Reset the event
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Check whether the event is set
+   *
+   * @return true If the event is set
+   * @return false If the event is not set
+   */
+  bool is_set() const;
+};
+
+/**
+ * @brief A bounded multi-producer multi-consumer channel for coroutines on
+ * one worker. Values are stored in a ring allocated at construction. A sender
+ * waiting on a full channel keeps its value in its own frame.
+ *
+ * @tparam T The value type
+ */
+template <class T> class channel : public noncopyable {
+  worker *worker_;
+  std::vector<std::optional<T>> ring_;
+  size_t head_;
+  size_t size_;
+  bool closed_;
+  detail::waiter_queue senders_;
+  detail::waiter_queue receivers_;
+
+  void push(T &&value) {
+    ring_[(head_ + size_) % ring_.size()].emplace(std::move(value));
+    ++size_;
+  }
+
+  T pop() {
+    T value = std::move(*ring_[head_]);
+    ring_[head_].reset();
+    head_ = (head_ + 1) % ring_.size();
+    --size_;
+    return value;
+  }
+
+public:
+  class send_awaitable : public detail::waiter {
+    friend class channel;
+    channel *channel_;
+    T value_;
+    bool sent_;
+
+  public:
+    send_awaitable(channel *channel, T value)
+        : channel_(channel), value_(std::move(value)), sent_(false) {}
+
+    bool await_ready() noexcept {
+      auto ch = channel_;
+      if (ch->closed_) {
+        return true;
+      }
+      if (!ch->receivers_.empty()) {
+        auto receiver = static_cast<recv_awaitable *>(ch->receivers_.pop());
+        receiver->value_.emplace(std::move(value_));
+        ch->worker_->post(receiver);
+        sent_ = true;
+        return true;
+      }
+      if (ch->size_ < ch->ring_.size() && ch->senders_.empty()) {
+        ch->push(std::move(value_));
+        sent_ = true;
+        return true;
+      }
+      return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+      h_ = h;
+      channel_->senders_.push(this);
+    }
+
+    /* Returns false if the channel was closed before the value was sent */
+    bool await_resume() const { return sent_; }
+  };
+
+  class recv_awaitable : public detail::waiter {
+    friend class channel;
+    channel *channel_;
+    std::optional<T> value_;
+
+  public:
+    recv_awaitable(channel *channel) : channel_(channel) {}
+
+    bool await_ready() noexcept {
+      auto ch = channel_;
+      if (ch->size_ > 0) {
+        value_.emplace(ch->pop());
+        ch->admit_sender();
+        return true;
+      }
+      if (!ch->senders_.empty()) {
+        auto sender = static_cast<send_awaitable *>(ch->senders_.pop());
+        value_.emplace(std::move(sender->value_));
+        sender->sent_ = true;
+        ch->worker_->post(sender);
+        return true;
+      }
+      return ch->closed_;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+      h_ = h;
+      channel_->receivers_.push(this);
+    }
+
+    /* Returns std::nullopt if the channel is closed and drained */
+    std::optional<T> await_resume() { return std::move(value_); }
+  };
+
+  /**
+   * @brief Construct a new channel object
+   *
+   * @param worker The worker that resumes waiters
+   * @param capacity The number of values buffered before senders wait
+   */
+  channel(worker &worker, size_t capacity)
+      : worker_(&worker), ring_(capacity == 0 ? 1 : capacity), head_(0),
+        size_(0), closed_(false) {}
+
+  /**
+   * @brief Send a value
+   *
+   * @param value The value to send
+   * @return send_awaitable A coroutine that returns true when the value is
+   * buffered or received, or false if the channel is closed
+   */
+  send_awaitable send(T value) {
+    return send_awaitable(this, std::move(value));
+  }
+
+  /**
+   * @brief Receive a value
+   *
+   * @return recv_awaitable A coroutine that returns the value, or
+   * std::nullopt if the channel is closed and drained
+   */
+  recv_awaitable recv() { return recv_awaitable(this); }
+
+  /**
+   * @brief Close the channel. Buffered values can still be received. Waiting
+   * senders and receivers are woken up empty-handed.
+   *
+   */
+  void close() {
+    closed_ = true;
+    worker_->post(senders_);
+    worker_->post(receivers_);
+  }
+
+  /**
+   * @brief Get the number of buffered values
+   *
+   * @return size_t The number of buffered values
+   */
+  size_t size() const { return size_; }
+
+private:
+  /* Moves the first waiting sender's value into the ring */
+  void admit_sender() {
+    if (senders_.empty()) {
+      return;
+    }
+    auto sender = static_cast<send_awaitable *>(senders_.pop());
+    push(std::move(sender->value_));
+    sender->sent_ = true;
+    worker_->post(sender);
+  }
+};
+
+} // namespace ucxpp
\ No newline at end of file
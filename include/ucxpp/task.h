@@ -101,8 +101,12 @@ template <class T> struct task {
   std::future<T> &get_future() const { return h_.promise().get_future(); }
   void detach() {
     assert(!detached_);
-    h_.promise().set_detached_task(h_);
     detached_ = true;
+    if (h_.done()) {
+      h_.destroy();
+      return;
+    }
+    h_.promise().set_detached_task(h_);
   }
 };
 
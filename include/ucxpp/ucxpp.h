@@ -1,7 +1,25 @@
 #pragma once
 
 #include "ucxpp/address.h"
+#include "ucxpp/aggregator.h"
+#include "ucxpp/compact_endpoint.h"
+#include "ucxpp/completion.h"
+#include "ucxpp/completion_queue.h"
 #include "ucxpp/context.h"
+#include "ucxpp/credit.h"
+#include "ucxpp/datatype.h"
 #include "ucxpp/endpoint.h"
+#include "ucxpp/generator.h"
+#include "ucxpp/mailbox.h"
+#include "ucxpp/pipeline.h"
+#include "ucxpp/prepared.h"
+#include "ucxpp/pubsub.h"
+#include "ucxpp/qos.h"
+#include "ucxpp/rate_limiter.h"
+#include "ucxpp/recv_pool.h"
+#include "ucxpp/rpc.h"
+#include "ucxpp/stream.h"
+#include "ucxpp/sync.h"
 #include "ucxpp/task.h"
+#include "ucxpp/window.h"
 #include "ucxpp/worker.h"
\ No newline at end of file
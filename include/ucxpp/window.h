@@ -0,0 +1,178 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "ucxpp/worker.h"
+
+#include "ucxpp/detail/noncopyable.h"
+#include "ucxpp/detail/waiter_queue.h"
+
+namespace ucxpp {
+
+class window_controller;
+
+/**
+ * @brief Tuning of a window_controller.
+ *
+ */
+struct window_options {
+  /* Window before any completion is observed */
+  size_t initial = 4;
+  size_t min = 1;
+  size_t max = 1024;
+  /* Smoothed completion latency to stay under. Zero grows the window until
+   * bandwidth stops improving instead. */
+  std::chrono::nanoseconds target_latency{0};
+  /* Factor applied to the window on congestion */
+  double decrease = 0.5;
+  /* Relative bandwidth gain per window below which bandwidth has plateaued */
+  double plateau_gain = 0.05;
+};
+
+/* An operation waiting for a window slot */
+struct window_waiter : public detail::waiter {
+  void (*admit_)(window_waiter *);
+};
+
+/* Issues the wrapped operation once the controller grants a window slot */
+template <class Awaitable> class window_op : public window_waiter {
+  window_controller *controller_;
+  Awaitable inner_;
+  size_t bytes_;
+  std::chrono::steady_clock::time_point start_;
+  bool queued_;
+
+  bool suspend_inner(std::coroutine_handle<> h) {
+    if constexpr (std::is_void_v<decltype(inner_.await_suspend(h))>) {
+      inner_.await_suspend(h);
+      return true;
+    } else {
+      return inner_.await_suspend(h);
+    }
+  }
+
+  static void admit(window_waiter *waiter);
+
+public:
+  window_op(window_controller *controller, Awaitable inner, size_t bytes)
+      : controller_(controller), inner_(std::move(inner)), bytes_(bytes),
+        queued_(false) {
+    admit_ = &admit;
+  }
+
+  bool await_ready() noexcept;
+
+  bool await_suspend(std::coroutine_handle<> h) {
+    if (queued_) {
+      h_ = h;
+      return true;
+    }
+    return suspend_inner(h);
+  }
+
+  decltype(auto) await_resume();
+};
+
+/**
+ * @brief Limits the operations in flight on one worker to a window adapted by
+ * AIMD. The window grows by one per window of completions and shrinks by a
+ * factor when the smoothed latency exceeds the target, or, without a target,
+ * when bandwidth stops improving. Waiting operations are issued in FIFO order
+ * as slots free up.
+ *
+ */
+class window_controller : public noncopyable {
+  template <class Awaitable> friend class window_op;
+  using clock = std::chrono::steady_clock;
+  worker *worker_;
+  window_options options_;
+  double window_;
+  size_t in_flight_;
+  double srtt_ns_;
+  size_t since_decrease_;
+  size_t epoch_ops_;
+  size_t epoch_bytes_;
+  clock::time_point epoch_start_;
+  double best_bandwidth_;
+  size_t flat_epochs_;
+  detail::waiter_queue waiters_;
+
+  bool try_admit();
+  void complete(clock::time_point start, size_t bytes);
+  void on_sample(double latency_ns, size_t bytes);
+
+public:
+  /**
+   * @brief Construct a new window controller object
+   *
+   * @param worker The worker the wrapped operations run on
+   * @param options The window bounds and the adaptation targets
+   */
+  window_controller(worker &worker, window_options const &options = {});
+
+  /**
+   * @brief Run an operation within the window
+   *
+   * @param op The operation, e.g. the result of endpoint::tag_send
+   * @param bytes The bytes transferred, used in bandwidth mode. If zero for
+   * all operations, the operation rate is used instead.
+   * @return window_op<Awaitable> A coroutine that returns the operation's
+   * result
+   */
+  template <class Awaitable>
+  window_op<Awaitable> run(Awaitable op, size_t bytes = 0) {
+    return window_op<Awaitable>(this, std::move(op), bytes);
+  }
+
+  /**
+   * @brief Get the current window
+   *
+   * @return size_t The number of operations allowed in flight
+   */
+  size_t window() const;
+
+  /**
+   * @brief Get the number of operations in flight
+   *
+   * @return size_t The number of operations in flight
+   */
+  size_t in_flight() const;
+
+  /**
+   * @brief Get the smoothed completion latency
+   *
+   * @return std::chrono::nanoseconds The smoothed completion latency
+   */
+  std::chrono::nanoseconds smoothed_latency() const;
+};
+
+template <class Awaitable>
+void window_op<Awaitable>::admit(window_waiter *waiter) {
+  auto self = static_cast<window_op *>(waiter);
+  self->start_ = std::chrono::steady_clock::now();
+  self->queued_ = false;
+  if (self->inner_.await_ready() || !self->suspend_inner(self->h_)) {
+    self->controller_->worker_->post(self);
+  }
+}
+
+template <class Awaitable> bool window_op<Awaitable>::await_ready() noexcept {
+  if (controller_->waiters_.empty() && controller_->try_admit()) {
+    start_ = std::chrono::steady_clock::now();
+    return inner_.await_ready();
+  }
+  queued_ = true;
+  controller_->waiters_.push(this);
+  return false;
+}
+
+template <class Awaitable> decltype(auto) window_op<Awaitable>::await_resume() {
+  controller_->complete(start_, bytes_);
+  return inner_.await_resume();
+}
+
+} // namespace ucxpp
\ No newline at end of file
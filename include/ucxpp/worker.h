@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <ucs/type/status.h>
@@ -10,19 +11,52 @@
 #include "ucxpp/address.h"
 #include "ucxpp/awaitable.h"
 #include "ucxpp/context.h"
+#include "ucxpp/datatype.h"
+#include "ucxpp/generator.h"
+#include "ucxpp/rate_limiter.h"
+
+#include "ucxpp/detail/resume.h"
+#include "ucxpp/detail/waiter_queue.h"
 
 namespace ucxpp {
 
+/**
+ * @brief How a worker resumes coroutines whose operations complete
+ *
+ */
+enum class completion_mode {
+  /* Resume inside the UCX callback, nested in ucp_worker_progress() */
+  inline_resume,
+  /* Queue the coroutine and resume it after ucp_worker_progress() returns */
+  queued,
+};
+
 /**
  * @brief Abstraction for a UCX worker.
  *
  */
 class worker : public std::enable_shared_from_this<worker> {
   friend class local_address;
-  friend class endpoint;
+  friend class endpoint_base;
+  friend class worker_close_all_awaitable;
+  friend class rate_limiter;
   ucp_worker_h worker_;
   std::shared_ptr<context> ctx_;
   int event_fd_;
+  endpoint_base *endpoints_;
+  size_t num_endpoints_;
+  worker_close_all_awaitable *closing_;
+  rate_limiter *pacing_;
+  std::unique_ptr<rate_limiter> rate_limiter_;
+  mutable detail::waiter_queue ready_;
+  mutable detail::resume_ring completions_;
+  bool queue_completions_;
+  size_t completion_budget_;
+
+  void drain_completions() const;
+
+  void link_endpoint(endpoint_base *ep);
+  void unlink_endpoint(endpoint_base *ep);
 
 public:
   /**
@@ -62,7 +96,69 @@ public:
   ucp_worker_h handle() const;
 
   /**
-   * @brief Progress the worker
+   * @brief Get the number of live endpoints created on this worker
+   *
+   * @return size_t The number of live endpoints
+   */
+  size_t num_endpoints() const;
+
+  /**
+   * @brief Limit the bytes per second of paced operations on all endpoints of
+   * this worker
+   *
+   * @param bytes_per_sec Sustained rate in bytes per second, 0 to remove the
+   * limit. Paced operations waiting for tokens are then admitted.
+   * @param burst Bucket size in bytes
+   */
+  void set_rate_limit(size_t bytes_per_sec, size_t burst);
+
+  /**
+   * @brief Get the worker's rate limiter
+   *
+   * @return rate_limiter* The worker's rate limiter, or null if no limit was
+   * ever set. A removed limit leaves a limiter that admits everything.
+   */
+  rate_limiter *rate_limiter_ptr() const;
+
+  /**
+   * @brief Queue a suspended coroutine to be resumed by the next progress()
+   * instead of resuming it on the caller's stack
+   *
+   * @param waiter The waiter to resume
+   */
+  void post(detail::waiter *waiter);
+
+  /**
+   * @brief Queue all the waiters to be resumed by the next progress()
+   *
+   * @param waiters The waiters to resume. The queue is emptied.
+   */
+  void post(detail::waiter_queue &waiters);
+
+  /**
+   * @brief Set how coroutines are resumed when their operations complete. In
+   * queued mode, UCX callbacks only record the coroutine, and progress()
+   * resumes at most budget of them after UCX returns, oldest first. Coroutines
+   * then never run nested inside UCX, and one progress() call does a bounded
+   * amount of application work.
+   *
+   * @param mode The completion mode
+   * @param budget Maximum coroutines resumed per progress() in queued mode
+   */
+  void set_completion_mode(completion_mode mode, size_t budget = 64);
+
+  /**
+   * @brief Get the number of completed operations whose coroutines have not
+   * been resumed yet
+   *
+   * @return size_t The number of queued completions
+   */
+  size_t queued_completions() const;
+
+  /**
+   * @brief Progress the worker. If close_all() is in progress, its deadline is
+   * also checked here. Operations waiting on rate limiters of this worker are
+   * admitted here, and posted waiters and queued completions are resumed.
    *
    * @return true If progress was made
    * @return false If no progress was made
@@ -80,8 +176,10 @@ public:
    * @brief Arm the worker for next event notification.
    *
    * @return true If the worker was armed
-   * @return false If the worker has pending events. In this case, the user must
-   * call progress() until it returns false.
+   * @return false If the worker has pending events, posted waiters or queued
+   * completions, paced operations are waiting for tokens, or close_all() has
+   * passed its deadline. In this case, the user must call progress() until it
+   * returns false.
    */
   bool arm() const;
 
@@ -98,6 +196,38 @@ public:
   tag_recv_awaitable tag_recv(void *buffer, size_t length, ucp_tag_t tag,
                               ucp_tag_t tag_mask = 0xFFFFFFFFFFFFFFFF) const;
 
+  /**
+   * @brief Receive tag messages into the same buffer over and over. Each
+   * message must be consumed before the next one is pulled.
+   *
+   * @param buffer The buffer to receive to
+   * @param length The length of the buffer
+   * @param tag The tag to receive with
+   * @param tag_mask The bit mask for tag matching, 0 means accepting any tag
+   * @return async_generator<std::pair<size_t, ucp_tag_t>> A generator of the
+   * number of bytes received and the sender tag of each message
+   */
+  async_generator<std::pair<size_t, ucp_tag_t>>
+  tag_recv_stream(void *buffer, size_t length, ucp_tag_t tag,
+                  ucp_tag_t tag_mask = 0xFFFFFFFFFFFFFFFF) const;
+
+  /**
+   * @brief Tag receive into an object, unpacked by UCX through pack_traits<T>
+   *
+   * @param object The object to receive into
+   * @param tag The tag to receive with
+   * @param tag_mask The bit mask for tag matching, 0 means accepting any tag
+   * @return tag_recv_awaitable A coroutine that returns a pair of number of
+   * packed bytes received and the sender tag upon completion
+   */
+  template <class T>
+  tag_recv_awaitable
+  tag_recv_object(T &object, ucp_tag_t tag,
+                  ucp_tag_t tag_mask = 0xFFFFFFFFFFFFFFFF) const {
+    return tag_recv_awaitable(worker_, &object, 1, tag, tag_mask,
+                              generic_datatype<T>::instance().handle());
+  }
+
   /**
    * @brief Fence the worker. Operations issued on the worker before the fence
    * are ensured to complete before operations issued after the fence.
@@ -113,6 +243,25 @@ public:
    */
   worker_flush_awaitable flush();
 
+  /**
+   * @brief Close all live endpoints created on this worker at once. In flush
+   * mode, every endpoint is flushed first and then closed. Endpoints that are
+   * not flushed when the deadline passes are force closed. Endpoints closed
+   * this way should not be used afterwards.
+   *
+   * @param mode UCP_EP_CLOSE_MODE_FLUSH or UCP_EP_CLOSE_MODE_FORCE
+   * @param deadline The time point after which remaining endpoints are force
+   * closed. It is only checked by progress(), so an event loop that sleeps in
+   * wait() or on event_fd() must wake up by the deadline itself. arm() fails
+   * once the deadline has passed.
+   * @return worker_close_all_awaitable A coroutine that returns when all close
+   * requests are completed
+   */
+  worker_close_all_awaitable
+  close_all(ucp_ep_close_mode mode = UCP_EP_CLOSE_MODE_FLUSH,
+            std::chrono::steady_clock::time_point deadline =
+                std::chrono::steady_clock::time_point::max());
+
   ~worker();
 };
 
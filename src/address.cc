@@ -1,8 +1,6 @@
 #include "ucxpp/address.h"
 
-#include <algorithm>
 #include <cstddef>
-#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -33,13 +31,22 @@ local_address &local_address::operator=(local_address &&other) {
 }
 
 std::vector<char> local_address::serialize() const {
-  std::vector<char> buffer;
-  auto it = std::back_inserter(buffer);
-  detail::serialize(address_length_, it);
-  std::copy_n(reinterpret_cast<char const *>(address_), address_length_, it);
+  std::vector<char> buffer(serialized_size());
+  serialize(buffer.data());
   return buffer;
 }
 
+size_t local_address::serialized_size() const {
+  return sizeof(address_length_) + address_length_;
+}
+
+size_t local_address::serialize(void *buffer) const {
+  return detail::flat_writer(buffer)
+      .put(address_length_)
+      .put_bytes(address_, address_length_)
+      .size();
+}
+
 const ucp_address_t *local_address::get_address() const { return address_; }
 
 size_t local_address::get_length() const { return address_length_; }
@@ -0,0 +1,219 @@
+#include "ucxpp/aggregator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "ucxpp/error.h"
+
+#include "ucxpp/detail/debug.h"
+#include "ucxpp/detail/serdes.h"
+
+namespace ucxpp {
+
+void tag_aggregator::idle_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  aggregator_->waiters_.push(this);
+}
+
+tag_aggregator::tag_aggregator(std::shared_ptr<endpoint> endpoint,
+                               ucp_tag_t tag, size_t capacity,
+                               size_t threshold,
+                               std::chrono::steady_clock::duration max_delay,
+                               size_t depth)
+    : endpoint_(endpoint), tag_(tag), capacity_(capacity),
+      threshold_(std::min(threshold, capacity)), max_delay_(max_delay),
+      current_(0) {
+  if (depth == 0 || capacity <= sizeof(length_type)) {
+    throw_with("invalid aggregator depth %zu or capacity %zu", depth,
+               capacity);
+  }
+  auto ctx = endpoint_->worker_ptr()->context_ptr();
+  mrs_.reserve(depth);
+  batches_.reserve(depth);
+  for (size_t i = 0; i < depth; ++i) {
+    auto [buffer, mr] = local_memory_handle::allocate_mem(ctx, capacity);
+    mrs_.push_back(std::move(mr));
+    batches_.push_back(batch{static_cast<char *>(buffer), 0, false});
+  }
+}
+
+tag_aggregator::batch *tag_aggregator::seal() {
+  auto &b = batches_[current_];
+  if (b.in_flight || b.used == 0) {
+    return nullptr;
+  }
+  b.in_flight = true;
+  current_ = (current_ + 1) % batches_.size();
+  return &b;
+}
+
+task<void> tag_aggregator::send_batch(batch *b) {
+  try {
+    co_await endpoint_->tag_send(b->buffer, b->used, tag_);
+  } catch (...) {
+    error_ = std::current_exception();
+  }
+  b->used = 0;
+  b->in_flight = false;
+  endpoint_->worker_ptr()->post(waiters_);
+}
+
+bool tag_aggregator::push(void const *data, size_t length) {
+  if (error_) [[unlikely]] {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+  auto record = sizeof(length_type) + length;
+  if (record > capacity_) [[unlikely]] {
+    throw_with("message of %zu bytes exceeds aggregator capacity %zu", length,
+               capacity_);
+  }
+  if (batches_[current_].in_flight) {
+    return false;
+  }
+  if (batches_[current_].used + record > capacity_) {
+    send_batch(seal()).detach();
+    if (batches_[current_].in_flight) {
+      return false;
+    }
+  }
+  auto &b = batches_[current_];
+  if (b.used == 0) {
+    first_push_ = std::chrono::steady_clock::now();
+  }
+  auto it = b.buffer + b.used;
+  detail::serialize(static_cast<length_type>(length), it);
+  std::memcpy(it + sizeof(length_type), data, length);
+  b.used += record;
+  if (b.used >= threshold_) {
+    send_batch(seal()).detach();
+  }
+  return true;
+}
+
+task<void> tag_aggregator::write(void const *data, size_t length) {
+  while (!push(data, length)) {
+    co_await idle_awaitable(this);
+  }
+}
+
+bool tag_aggregator::poll() {
+  auto &b = batches_[current_];
+  if (b.in_flight || b.used == 0 ||
+      std::chrono::steady_clock::now() - first_push_ < max_delay_) {
+    return false;
+  }
+  send_batch(seal()).detach();
+  return true;
+}
+
+task<void> tag_aggregator::flush() {
+  if (auto b = seal()) {
+    send_batch(b).detach();
+  }
+  while (in_flight() > 0) {
+    co_await idle_awaitable(this);
+  }
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+size_t tag_aggregator::in_flight() const {
+  size_t n = 0;
+  for (auto const &b : batches_) {
+    n += b.in_flight;
+  }
+  return n;
+}
+
+tag_aggregator::~tag_aggregator() {
+  assert(in_flight() == 0);
+  assert(waiters_.empty());
+}
+
+tag_batch::tag_batch(void const *buffer, size_t length)
+    : begin_(static_cast<char const *>(buffer)), end_(begin_ + length) {}
+
+void tag_batch::iterator::check() {
+  if (pos_ == end_) {
+    return;
+  }
+  auto it = pos_;
+  tag_aggregator::length_type length;
+  if (static_cast<size_t>(end_ - it) < sizeof(length)) [[unlikely]] {
+    pos_ = end_;
+    return;
+  }
+  detail::deserialize(it, length);
+  if (length > static_cast<size_t>(end_ - it)) [[unlikely]] {
+    pos_ = end_;
+  }
+}
+
+tag_batch::message tag_batch::iterator::operator*() const {
+  auto it = pos_;
+  tag_aggregator::length_type length;
+  detail::deserialize(it, length);
+  return message{it, length};
+}
+
+tag_batch::iterator &tag_batch::iterator::operator++() {
+  auto it = pos_;
+  tag_aggregator::length_type length;
+  detail::deserialize(it, length);
+  pos_ = it + length;
+  check();
+  return *this;
+}
+
+tag_batch::iterator tag_batch::iterator::operator++(int) {
+  auto old = *this;
+  ++*this;
+  return old;
+}
+
+tag_batch::iterator tag_batch::begin() const {
+  return iterator(begin_, end_);
+}
+
+tag_batch::iterator tag_batch::end() const { return iterator(end_, end_); }
+
+bool tag_batch::valid() const {
+  auto it = begin_;
+  while (it != end_) {
+    tag_aggregator::length_type length;
+    if (static_cast<size_t>(end_ - it) < sizeof(length)) {
+      return false;
+    }
+    detail::deserialize(it, length);
+    if (length > static_cast<size_t>(end_ - it)) {
+      return false;
+    }
+    it += length;
+  }
+  return true;
+}
+
+async_generator<tag_batch::message> unbatch(tag_recv_pool &pool) {
+  while (true) {
+    auto buffer = co_await pool.recv();
+    auto batch = tag_batch(buffer.data(), buffer.length());
+    if (!batch.valid()) [[unlikely]] {
+      UCXPP_LOG_ERROR("malformed batch of %zu bytes, tail dropped",
+                      buffer.length());
+    }
+    for (auto message : batch) {
+      co_yield message;
+    }
+  }
+}
+
+} // namespace ucxpp
\ No newline at end of file
@@ -1,41 +1,191 @@
 #include "ucxpp/awaitable.h"
 
+#include <chrono>
 #include <memory>
+#include <utility>
 
 #include "ucxpp/endpoint.h"
 #include "ucxpp/worker.h"
 
+#include "ucxpp/detail/debug.h"
+#include "ucxpp/detail/resume.h"
+
 namespace ucxpp {
 
+void base_awaitable::link_owner() { owner_->link_inflight(this); }
+
+void base_awaitable::unlink_owner() { owner_->unlink_inflight(this); }
+
 ep_flush_awaitable::ep_flush_awaitable(std::shared_ptr<endpoint const> endpoint)
-    : endpoint_(endpoint) {}
+    : endpoint_(endpoint), ep_(endpoint->handle()) {}
+
+ep_flush_awaitable::ep_flush_awaitable(ucp_ep_h ep) : ep_(ep) {}
 
 bool ep_flush_awaitable::await_ready() noexcept {
-  auto send_param = build_param();
-  auto request = ::ucp_ep_flush_nbx(endpoint_->handle(), &send_param);
-  return check_request_ready(request);
+  if (rejected()) [[unlikely]] {
+    return true;
+  }
+  return check_request_ready(post_ep_flush(ep_, *this));
 }
 
 ep_close_awaitable::ep_close_awaitable(std::shared_ptr<endpoint> endpoint)
-    : endpoint_(endpoint) {}
+    : endpoint_(endpoint), base_(endpoint.get()) {}
+
+ep_close_awaitable::ep_close_awaitable(endpoint_base *endpoint)
+    : base_(endpoint) {}
 
 bool ep_close_awaitable::await_ready() noexcept {
+  if (base_->ep_ == nullptr) {
+    /* Already closed after an error */
+    status_ = UCS_OK;
+    return true;
+  }
   auto send_param = build_param();
-  auto request = ::ucp_ep_close_nbx(endpoint_->handle(), &send_param);
+  auto request = ::ucp_ep_close_nbx(base_->ep_, &send_param);
   if (check_request_ready(request)) {
     return true;
   }
-  endpoint_->close_request_ = request;
+  base_->close_request_ = request;
   return false;
 }
 
+ep_failure_awaitable::ep_failure_awaitable(endpoint_base *endpoint)
+    : endpoint_(endpoint), next_(nullptr), status_(UCS_OK) {}
+
+bool ep_failure_awaitable::await_ready() noexcept {
+  status_ = endpoint_->status();
+  return status_ != UCS_OK;
+}
+
+void ep_failure_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  next_ = std::exchange(endpoint_->failure_waiters_, this);
+}
+
 worker_flush_awaitable::worker_flush_awaitable(std::shared_ptr<worker> worker)
     : worker_(worker) {}
 
 bool worker_flush_awaitable::await_ready() noexcept {
-  auto send_param = build_param();
-  auto request = ::ucp_worker_flush_nbx(worker_->handle(), &send_param);
-  return check_request_ready(request);
+  return check_request_ready(post_worker_flush(worker_->handle(), *this));
+}
+
+worker_close_all_awaitable::worker_close_all_awaitable(
+    std::shared_ptr<worker> worker, ucp_ep_close_mode mode,
+    std::chrono::steady_clock::time_point deadline)
+    : worker_(worker), mode_(mode), deadline_(deadline), pending_(0),
+      forced_(false) {}
+
+void worker_close_all_awaitable::flush_cb(void *request, ucs_status_t status,
+                                          void *user_data) {
+  auto entry = reinterpret_cast<close_entry *>(user_data);
+  ::ucp_request_free(request);
+  if (!entry->closing) {
+    entry->self->start_close(*entry, status != UCS_OK);
+  }
+  entry->self->complete_one();
+}
+
+void worker_close_all_awaitable::close_cb(void *request, ucs_status_t status,
+                                          void *user_data) {
+  auto entry = reinterpret_cast<close_entry *>(user_data);
+  if (status != UCS_OK) {
+    UCXPP_LOG_ERROR("ep_h=%p close failed: %s",
+                    reinterpret_cast<void *>(entry->ep),
+                    ::ucs_status_string(status));
+  }
+  ::ucp_request_free(request);
+  entry->self->complete_one();
+}
+
+void worker_close_all_awaitable::start_flush(close_entry &entry) {
+  ucp_request_param_t param;
+  param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK | UCP_OP_ATTR_FIELD_USER_DATA;
+  param.cb.send = &flush_cb;
+  param.user_data = &entry;
+  auto request = ::ucp_ep_flush_nbx(entry.ep, &param);
+  if (UCS_PTR_IS_PTR(request)) {
+    ++pending_;
+  } else {
+    start_close(entry, UCS_PTR_IS_ERR(request));
+  }
+}
+
+void worker_close_all_awaitable::start_close(close_entry &entry, bool force) {
+  ucp_request_param_t param;
+  param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                       UCP_OP_ATTR_FIELD_USER_DATA | UCP_OP_ATTR_FIELD_FLAGS;
+  param.flags = force ? UCP_EP_CLOSE_FLAG_FORCE : 0;
+  param.cb.send = &close_cb;
+  param.user_data = &entry;
+  entry.closing = true;
+  /* Counted first, as a forced close may complete the flush of this entry
+   * inline. The caller holds a count, so this cannot resume us. */
+  ++pending_;
+  auto request = ::ucp_ep_close_nbx(entry.ep, &param);
+  if (UCS_PTR_IS_PTR(request)) {
+    return;
+  }
+  --pending_;
+  if (UCS_PTR_IS_ERR(request)) {
+    UCXPP_LOG_ERROR("ep_h=%p close failed: %s",
+                    reinterpret_cast<void *>(entry.ep),
+                    ::ucs_status_string(UCS_PTR_STATUS(request)));
+  }
+}
+
+void worker_close_all_awaitable::complete_one() {
+  if (--pending_ == 0 && h_) {
+    worker_->closing_ = nullptr;
+    detail::resume(h_);
+  }
+}
+
+void worker_close_all_awaitable::check_deadline() {
+  if (forced_ || std::chrono::steady_clock::now() < deadline_) {
+    return;
+  }
+  forced_ = true;
+  /* Guards against completions of forced entries resuming us mid-loop */
+  ++pending_;
+  for (auto &entry : entries_) {
+    if (!entry.closing) {
+      start_close(entry, true);
+    }
+  }
+  complete_one();
+}
+
+bool worker_close_all_awaitable::past_deadline() const {
+  return !forced_ && std::chrono::steady_clock::now() >= deadline_;
+}
+
+bool worker_close_all_awaitable::await_ready() noexcept {
+  entries_.reserve(worker_->num_endpoints_);
+  for (auto ep = worker_->endpoints_; ep != nullptr; ep = ep->next_) {
+    if (ep->ep_ == nullptr || ep->close_request_ != nullptr) {
+      continue;
+    }
+    entries_.push_back({this, std::exchange(ep->ep_, nullptr), false});
+  }
+
+  /* Entries are not touched by UCX until now, so pointers to them are stable */
+  forced_ = mode_ == UCP_EP_CLOSE_MODE_FORCE ||
+            std::chrono::steady_clock::now() >= deadline_;
+  ++pending_;
+  for (auto &entry : entries_) {
+    if (forced_) {
+      start_close(entry, true);
+    } else {
+      start_flush(entry);
+    }
+  }
+  return --pending_ == 0;
+}
+
+bool worker_close_all_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  worker_->closing_ = this;
+  return true;
 }
 
 } // namespace ucxpp
\ No newline at end of file
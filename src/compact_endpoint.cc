@@ -0,0 +1,82 @@
+#include "ucxpp/compact_endpoint.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/awaitable.h"
+#include "ucxpp/error.h"
+
+namespace ucxpp {
+
+compact_endpoint::compact_endpoint(worker &worker, ucp_address_t const *address,
+                                   ucp_err_handling_mode_t err_mode)
+    : worker_(&worker) {
+  open(worker, address, err_mode);
+}
+
+worker &compact_endpoint::worker_ref() const { return *worker_; }
+
+void compact_endpoint::print() const { ::ucp_ep_print_info(ep_, stdout); }
+
+ucp_ep_h compact_endpoint::handle() const { return ep_; }
+
+stream_send_awaitable compact_endpoint::stream_send(void const *buffer,
+                                                    size_t length) const {
+  return track(stream_send_awaitable(ep_, buffer, length));
+}
+
+stream_recv_awaitable compact_endpoint::stream_recv(void *buffer,
+                                                    size_t length) const {
+  return track(stream_recv_awaitable(ep_, buffer, length));
+}
+
+tag_send_awaitable compact_endpoint::tag_send(void const *buffer,
+                                              size_t length,
+                                              ucp_tag_t tag) const {
+  return track(tag_send_awaitable(ep_, buffer, length, tag));
+}
+
+ep_flush_awaitable compact_endpoint::flush() const {
+  return track(ep_flush_awaitable(ep_));
+}
+
+task<void> compact_endpoint::close() {
+  co_await ep_close_awaitable(this);
+  ep_ = nullptr;
+  co_return;
+}
+
+compact_endpoint::~compact_endpoint() { release(*worker_); }
+
+void endpoint_pool::deleter::operator()(compact_endpoint *ep) const {
+  ep->~compact_endpoint();
+  pool->slab_.deallocate(ep);
+}
+
+endpoint_pool::endpoint_pool(std::shared_ptr<worker> worker, size_t chunk_size,
+                             ucp_err_handling_mode_t err_mode)
+    : worker_(worker), slab_(chunk_size), err_mode_(err_mode) {}
+
+endpoint_pool::pointer endpoint_pool::create(remote_address const &peer) {
+  return create(peer.get_address());
+}
+
+endpoint_pool::pointer endpoint_pool::create(ucp_address_t const *address) {
+  auto storage = slab_.allocate();
+  try {
+    auto ep = new (storage) compact_endpoint(*worker_, address, err_mode_);
+    return pointer(ep, deleter{this});
+  } catch (...) {
+    slab_.deallocate(storage);
+    throw;
+  }
+}
+
+size_t endpoint_pool::size() const { return slab_.size(); }
+
+std::shared_ptr<worker> endpoint_pool::worker_ptr() const { return worker_; }
+
+} // namespace ucxpp
\ No newline at end of file
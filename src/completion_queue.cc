@@ -0,0 +1,17 @@
+#include "ucxpp/completion_queue.h"
+
+#include <cstddef>
+
+namespace ucxpp {
+
+completion_queue::completion_queue(size_t capacity) : records_(capacity) {}
+
+size_t completion_queue::poll(completion_record *records, size_t max) {
+  size_t count = 0;
+  while (count < max && !records_.empty()) {
+    records[count++] = records_.pop();
+  }
+  return count;
+}
+
+} // namespace ucxpp
\ No newline at end of file
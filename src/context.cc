@@ -1,7 +1,11 @@
 #include "ucxpp/context.h"
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
 #include <ucs/config/types.h>
 
 #include <ucp/api/ucp.h>
@@ -12,10 +16,27 @@
 
 namespace ucxpp {
 
-context::builder::builder() : features_(0), print_config_(false) {}
+namespace {
+
+struct startup_profile {
+  char const *name;
+  char const *transports;
+};
+
+constexpr startup_profile kStartupProfiles[] = {
+    {"local-only", "self,sm"},
+    {"tcp", "self,sm,tcp"},
+    {"network", "self,sm,rc,ud,tcp"},
+};
+
+} // namespace
+
+context::builder::builder()
+    : features_(0), print_config_(false), print_startup_stats_(false),
+      enable_mt_(false), estimated_num_eps_(0), estimated_num_ppn_(0) {}
 
 std::shared_ptr<context> context::builder::build() {
-  return std::make_shared<context>(features_, print_config_, enable_mt_);
+  return std::make_shared<context>(*this);
 }
 
 context::builder &context::builder::enable_print_config() {
@@ -63,21 +84,138 @@ context::builder &context::builder::enable_mt() {
   return *this;
 }
 
+context::builder &context::builder::enable_print_startup_stats() {
+  print_startup_stats_ = true;
+  return *this;
+}
+
+context::builder &context::builder::set_config(std::string const &name,
+                                               std::string const &value) {
+  config_.emplace_back(name, value);
+  return *this;
+}
+
+context::builder &context::builder::transports(std::string const &transports) {
+  return set_config("TLS", transports);
+}
+
+context::builder &context::builder::devices(std::string const &devices) {
+  return set_config("NET_DEVICES", devices);
+}
+
+context::builder &context::builder::estimated_num_eps(size_t num_eps) {
+  estimated_num_eps_ = num_eps;
+  return *this;
+}
+
+context::builder &context::builder::estimated_num_ppn(size_t num_ppn) {
+  estimated_num_ppn_ = num_ppn;
+  return *this;
+}
+
+context::builder &context::builder::use_profile(std::string const &name) {
+  for (auto const &profile : kStartupProfiles) {
+    if (name == profile.name) {
+      return transports(profile.transports);
+    }
+  }
+  throw_with("unknown startup profile: %s", name.c_str());
+}
+
+context::builder &context::builder::keepalive(std::string const &interval,
+                                              size_t num_eps) {
+  set_config("KEEPALIVE_INTERVAL", interval);
+  if (num_eps > 0) {
+    set_config("KEEPALIVE_NUM_EPS", std::to_string(num_eps));
+  }
+  return *this;
+}
+
+context::builder &context::builder::load_profile(std::string const &filename) {
+  std::ifstream file(filename);
+  if (!file) {
+    throw_with("failed to open profile: %s", filename.c_str());
+  }
+  constexpr char kWhitespace[] = " \t\r";
+  constexpr std::string_view kPrefix = "UCX_";
+  std::string line;
+  while (std::getline(file, line)) {
+    auto begin = line.find_first_not_of(kWhitespace);
+    if (begin == std::string::npos || line[begin] == '#') {
+      continue;
+    }
+    auto end = line.find_last_not_of(kWhitespace);
+    line = line.substr(begin, end - begin + 1);
+    auto eq = line.find('=');
+    if (eq == std::string::npos || eq == 0) {
+      throw_with("malformed line in profile %s: %s", filename.c_str(),
+                 line.c_str());
+    }
+    auto name = line.substr(0, eq);
+    if (name.starts_with(kPrefix)) {
+      name = name.substr(kPrefix.size());
+    }
+    set_config(name, line.substr(eq + 1));
+  }
+  return *this;
+}
+
 context::context(uint64_t features, bool print_config, bool enable_mt)
-    : features_(features) {
+    : context([&]() {
+        builder builder;
+        builder.features_ = features;
+        builder.print_config_ = print_config;
+        builder.enable_mt_ = enable_mt;
+        return builder;
+      }()) {}
+
+context::context(builder const &builder) : features_(builder.features_) {
+  using clock = std::chrono::steady_clock;
+  auto read_start = clock::now();
   config config;
+  auto modify_start = clock::now();
+  for (auto const &[name, value] : builder.config_) {
+    config.modify(name.c_str(), value.c_str());
+  }
+  auto init_start = clock::now();
+
   ucp_params_t ucp_params;
   ucp_params.field_mask = UCP_PARAM_FIELD_FEATURES;
-  ucp_params.features = features;
-  if (enable_mt) {
+  ucp_params.features = builder.features_;
+  if (builder.enable_mt_) {
     ucp_params.field_mask |= UCP_PARAM_FIELD_MT_WORKERS_SHARED;
     ucp_params.mt_workers_shared = 1;
   }
+  if (builder.estimated_num_eps_ > 0) {
+    ucp_params.field_mask |= UCP_PARAM_FIELD_ESTIMATED_NUM_EPS;
+    ucp_params.estimated_num_eps = builder.estimated_num_eps_;
+  }
+  if (builder.estimated_num_ppn_ > 0) {
+    ucp_params.field_mask |= UCP_PARAM_FIELD_ESTIMATED_NUM_PPN;
+    ucp_params.estimated_num_ppn = builder.estimated_num_ppn_;
+  }
   check_ucs_status(::ucp_init(&ucp_params, config.handle(), &context_),
                    "failed to init ucp");
-  if (print_config) {
+  auto init_end = clock::now();
+
+  startup_stats_.config_read = modify_start - read_start;
+  startup_stats_.config_modify = init_start - modify_start;
+  startup_stats_.init = init_end - init_start;
+  if (builder.print_config_) {
     config.print();
   }
+  if (builder.print_startup_stats_) {
+    ::fprintf(stdout,
+              "ucxpp context startup: config_read=%.3fms "
+              "config_modify=%.3fms ucp_init=%.3fms\n",
+              startup_stats_.config_read.count() / 1e6,
+              startup_stats_.config_modify.count() / 1e6,
+              startup_stats_.init.count() / 1e6);
+  }
+}
+
+context::startup_stats const &context::get_startup_stats() const {
+  return startup_stats_;
 }
 
 uint64_t context::features() const { return features_; }
@@ -0,0 +1,141 @@
+#include "ucxpp/credit.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/awaitable.h"
+#include "ucxpp/endpoint.h"
+#include "ucxpp/error.h"
+
+#include "ucxpp/detail/serdes.h"
+
+namespace ucxpp {
+
+struct credit_awaitable::state {
+  size_t credits = 0;
+  credit_awaitable *waiters_head = nullptr;
+  credit_awaitable *waiters_tail = nullptr;
+  tag_recv_awaitable *recv = nullptr;
+  uint32_t grant = 0;
+  bool closed = false;
+
+  void release(size_t n) {
+    credits += n;
+    while (credits > 0 && waiters_head != nullptr) {
+      auto waiter = waiters_head;
+      waiters_head = waiter->next_;
+      if (waiters_head == nullptr) {
+        waiters_tail = nullptr;
+      }
+      --credits;
+      waiter->h_.resume();
+    }
+  }
+};
+
+credit_awaitable::credit_awaitable(state *state)
+    : state_(state), next_(nullptr) {}
+
+bool credit_awaitable::await_ready() noexcept {
+  if (state_->waiters_head == nullptr && state_->credits > 0) {
+    --state_->credits;
+    return true;
+  }
+  return false;
+}
+
+void credit_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  if (state_->waiters_tail != nullptr) {
+    state_->waiters_tail->next_ = this;
+  } else {
+    state_->waiters_head = this;
+  }
+  state_->waiters_tail = this;
+}
+
+credit_sender::credit_sender(std::shared_ptr<endpoint> endpoint,
+                             ucp_tag_t credit_tag, size_t initial_credits)
+    : endpoint_(endpoint),
+      state_(std::make_shared<credit_awaitable::state>()) {
+  state_->credits = initial_credits;
+  receive_credits(endpoint_->worker_ptr(), state_, credit_tag).detach();
+}
+
+task<void>
+credit_sender::receive_credits(std::shared_ptr<worker> worker,
+                               std::shared_ptr<credit_awaitable::state> state,
+                               ucp_tag_t credit_tag) {
+  while (!state->closed) {
+    try {
+      co_await tag_recv_awaitable(worker->handle(), &state->grant,
+                                  sizeof(state->grant), credit_tag,
+                                  0xFFFFFFFFFFFFFFFF, state->recv);
+    } catch (...) {
+      /* Cancelled on destruction, or the worker failed */
+      state->recv = nullptr;
+      break;
+    }
+    state->recv = nullptr;
+    auto it = reinterpret_cast<char const *>(&state->grant);
+    uint32_t credits;
+    detail::deserialize(it, credits);
+    state->release(credits);
+  }
+}
+
+credit_awaitable credit_sender::acquire() {
+  return credit_awaitable(state_.get());
+}
+
+void credit_sender::add_credits(size_t credits) { state_->release(credits); }
+
+size_t credit_sender::credits() const { return state_->credits; }
+
+task<void> credit_sender::tag_send(void const *buffer, size_t length,
+                                   ucp_tag_t tag) const {
+  co_await credit_awaitable(state_.get());
+  co_await endpoint_->tag_send(buffer, length, tag);
+}
+
+credit_sender::~credit_sender() {
+  assert(state_->waiters_head == nullptr);
+  state_->closed = true;
+  if (state_->recv != nullptr) {
+    state_->recv->cancel();
+  }
+}
+
+credit_receiver::credit_receiver(std::shared_ptr<endpoint> endpoint,
+                                 ucp_tag_t credit_tag, size_t batch)
+    : endpoint_(endpoint), credit_tag_(credit_tag),
+      batch_(batch == 0 ? 1 : batch), pending_(0) {}
+
+task<void> credit_receiver::send_credits(size_t credits) const {
+  uint32_t grant;
+  auto it = reinterpret_cast<char *>(&grant);
+  detail::serialize(static_cast<uint32_t>(credits), it);
+  co_await endpoint_->tag_send(&grant, sizeof(grant), credit_tag_);
+}
+
+task<void> credit_receiver::grant(size_t credits) {
+  pending_ += credits;
+  if (pending_ >= batch_) {
+    co_await send_credits(std::exchange(pending_, 0));
+  }
+}
+
+task<void> credit_receiver::flush() {
+  if (pending_ > 0) {
+    co_await send_credits(std::exchange(pending_, 0));
+  }
+}
+
+size_t credit_receiver::take_piggyback() { return std::exchange(pending_, 0); }
+
+} // namespace ucxpp
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "ucxpp/endpoint.h"
 
+#include <cassert>
 #include <cstddef>
 #include <memory>
 #include <ucs/type/status.h>
@@ -13,41 +14,203 @@
 #include "ucxpp/error.h"
 
 #include "ucxpp/detail/debug.h"
+#include "ucxpp/detail/resume.h"
 #include "ucxpp/detail/serdes.h"
 
 namespace ucxpp {
 
-void endpoint::error_cb(void *ep, ucp_ep_h ep_h, ucs_status_t status) {
-  UCXPP_LOG_ERROR("Endpoint error: ep=%p ep_h=%p status=%s", ep,
-                  reinterpret_cast<void *>(ep_h), ::ucs_status_string(status));
-  auto ep_ptr = reinterpret_cast<endpoint *>(ep);
-  if (!ep_ptr->close_request_) {
-    auto request = ::ucp_ep_close_nb(ep_h, UCP_EP_CLOSE_MODE_FLUSH);
-    if (UCS_PTR_IS_ERR(request)) {
-      UCXPP_LOG_ERROR(
-          "ep=%p ep_h=%p close failed: %s", ep, reinterpret_cast<void *>(ep_h),
-          ::ucs_status_string(UCS_PTR_STATUS(ep_ptr->close_request_)));
-      ep_ptr->close_request_ = nullptr;
-      ep_ptr->ep_ = nullptr;
-    } else if (UCS_PTR_IS_PTR(request)) {
-      ep_ptr->close_request_ = request;
-    } else {
-      ep_ptr->close_request_ = nullptr;
-      ep_ptr->ep_ = nullptr;
-    }
-  }
-}
+endpoint_base::endpoint_base()
+    : prev_(nullptr), next_(nullptr), status_(UCS_OK), track_inflight_(false),
+      inflight_(nullptr), failure_waiters_(nullptr), failure_hooks_(nullptr),
+      ep_(nullptr), close_request_(nullptr) {}
 
-endpoint::endpoint(std::shared_ptr<worker> worker, remote_address const &peer)
-    : worker_(worker), peer_(peer) {
+void endpoint_base::open(worker &worker, ucp_address_t const *address,
+                         ucp_err_handling_mode_t err_mode) {
   ucp_ep_params_t ep_params;
   ep_params.field_mask =
       UCP_EP_PARAM_FIELD_REMOTE_ADDRESS | UCP_EP_PARAM_FIELD_ERR_HANDLER;
-  ep_params.address = peer.get_address();
+  ep_params.address = address;
   ep_params.err_handler.cb = &error_cb;
   ep_params.err_handler.arg = this;
-  check_ucs_status(::ucp_ep_create(worker_->worker_, &ep_params, &ep_),
+  if (err_mode != UCP_ERR_HANDLING_MODE_NONE) {
+    ep_params.field_mask |= UCP_EP_PARAM_FIELD_ERR_HANDLING_MODE;
+    ep_params.err_mode = err_mode;
+    track_inflight_ = true;
+  }
+  check_ucs_status(::ucp_ep_create(worker.worker_, &ep_params, &ep_),
                    "failed to create ep");
+  worker.link_endpoint(this);
+}
+
+void endpoint_base::link_inflight(base_awaitable *awaitable) const {
+  awaitable->prev_ = nullptr;
+  awaitable->next_ = inflight_;
+  if (inflight_ != nullptr) {
+    inflight_->prev_ = awaitable;
+  }
+  inflight_ = awaitable;
+}
+
+void endpoint_base::unlink_inflight(base_awaitable *awaitable) const {
+  if (awaitable->prev_ != nullptr) {
+    awaitable->prev_->next_ = awaitable->next_;
+  } else {
+    inflight_ = awaitable->next_;
+  }
+  if (awaitable->next_ != nullptr) {
+    awaitable->next_->prev_ = awaitable->prev_;
+  }
+}
+
+void failure_hook::remove() {
+  if (owner_ != nullptr) {
+    owner_->unlink_failure_hook(*this);
+  }
+}
+
+void endpoint_base::add_failure_hook(failure_hook &hook) const {
+  assert(hook.owner_ == nullptr);
+  hook.owner_ = this;
+  hook.prev_ = nullptr;
+  hook.next_ = failure_hooks_;
+  if (failure_hooks_ != nullptr) {
+    failure_hooks_->prev_ = &hook;
+  }
+  failure_hooks_ = &hook;
+}
+
+void endpoint_base::unlink_failure_hook(failure_hook &hook) const {
+  if (hook.prev_ != nullptr) {
+    hook.prev_->next_ = hook.next_;
+  } else {
+    failure_hooks_ = hook.next_;
+  }
+  if (hook.next_ != nullptr) {
+    hook.next_->prev_ = hook.prev_;
+  }
+  hook.owner_ = nullptr;
+  hook.prev_ = hook.next_ = nullptr;
+}
+
+void endpoint_base::call_failure_hooks(ucs_status_t status) {
+  /* Hooks may remove others, so each is unlinked before it is called */
+  while (failure_hooks_ != nullptr) {
+    auto hook = failure_hooks_;
+    unlink_failure_hook(*hook);
+    hook->fn_(hook->arg_, status);
+  }
+}
+
+void endpoint_base::fail(ucs_status_t status) {
+  status_ = status;
+  for (auto awaitable = std::exchange(inflight_, nullptr);
+       awaitable != nullptr; awaitable = awaitable->next_) {
+    awaitable->owner_ = nullptr;
+    awaitable->status_ = status;
+  }
+
+  /*
+   * Force close completes all outstanding requests on the endpoint, possibly
+   * before it returns. Their coroutines are resumed only after this endpoint
+   * is updated, as they may destroy it.
+   */
+  detail::resume_ring completed;
+  auto ep = std::exchange(ep_, nullptr);
+  if (ep != nullptr && close_request_ == nullptr) {
+    ucp_request_param_t param;
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK | UCP_OP_ATTR_FIELD_FLAGS;
+    param.flags = UCP_EP_CLOSE_FLAG_FORCE;
+    param.cb.send = &close_cb;
+    ucs_status_ptr_t request;
+    {
+      detail::defer_resumes guard(&completed);
+      request = ::ucp_ep_close_nbx(ep, &param);
+    }
+    if (UCS_PTR_IS_ERR(request)) {
+      UCXPP_LOG_ERROR("ep=%p ep_h=%p close failed: %s",
+                      reinterpret_cast<void *>(this),
+                      reinterpret_cast<void *>(ep),
+                      ::ucs_status_string(UCS_PTR_STATUS(request)));
+    } else if (UCS_PTR_IS_PTR(request)) {
+      close_request_ = request;
+    }
+  }
+  {
+    detail::defer_resumes guard(&completed);
+    call_failure_hooks(status);
+  }
+
+  /* Nothing below touches this endpoint, which a resumption may destroy */
+  auto waiter = std::exchange(failure_waiters_, nullptr);
+  while (!completed.empty()) {
+    detail::resume(completed.pop());
+  }
+  while (waiter != nullptr) {
+    auto next = waiter->next_;
+    waiter->status_ = status;
+    detail::resume(waiter->h_);
+    waiter = next;
+  }
+}
+
+ucs_status_t endpoint_base::status() const { return status_; }
+
+ep_failure_awaitable endpoint_base::on_failure() {
+  return ep_failure_awaitable(this);
+}
+
+void endpoint_base::release(worker &worker) {
+  worker.unlink_endpoint(this);
+  for (auto awaitable = std::exchange(inflight_, nullptr);
+       awaitable != nullptr; awaitable = awaitable->next_) {
+    awaitable->owner_ = nullptr;
+  }
+
+  /* As in fail(), coroutines are resumed only after the endpoint is torn
+   * down, and through detail::resume() to honor queued completion mode */
+  detail::resume_ring completed;
+  {
+    detail::defer_resumes guard(&completed);
+    call_failure_hooks(UCS_ERR_NOT_CONNECTED);
+    if (ep_ != nullptr && close_request_ == nullptr) {
+      ucp_request_param_t param;
+      param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK;
+      param.cb.send = &close_cb;
+      ::ucp_ep_close_nbx(ep_, &param);
+    }
+  }
+
+  /* Nothing below touches this endpoint, which is being destroyed */
+  auto waiter = std::exchange(failure_waiters_, nullptr);
+  while (!completed.empty()) {
+    detail::resume(completed.pop());
+  }
+  while (waiter != nullptr) {
+    auto next = waiter->next_;
+    waiter->status_ = UCS_ERR_NOT_CONNECTED;
+    detail::resume(waiter->h_);
+    waiter = next;
+  }
+}
+
+void endpoint_base::error_cb(void *ep, ucp_ep_h ep_h, ucs_status_t status) {
+  UCXPP_LOG_ERROR("Endpoint error: ep=%p ep_h=%p status=%s", ep,
+                  reinterpret_cast<void *>(ep_h), ::ucs_status_string(status));
+  auto ep_ptr = reinterpret_cast<endpoint_base *>(ep);
+  ep_ptr->fail(status);
+}
+
+void endpoint_base::close_cb(void *request, ucs_status_t status,
+                             void *user_data) {
+  UCXPP_LOG_DEBUG("endpoint closed request=%p status=%s user_data=%p", request,
+                  ::ucs_status_string(status), user_data);
+  ::ucp_request_free(request);
+}
+
+endpoint::endpoint(std::shared_ptr<worker> worker, remote_address const &peer,
+                   ucp_err_handling_mode_t err_mode)
+    : worker_(worker), peer_(peer) {
+  open(*worker_, peer.get_address(), err_mode);
 }
 
 std::shared_ptr<worker> endpoint::worker_ptr() const { return worker_; }
@@ -60,20 +223,63 @@ const remote_address &endpoint::get_address() const { return peer_; }
 
 stream_send_awaitable endpoint::stream_send(void const *buffer,
                                             size_t length) const {
-  return stream_send_awaitable(ep_, buffer, length);
+  return track(stream_send_awaitable(ep_, buffer, length));
+}
+
+prepared_stream_send endpoint::prepare_stream_send(void const *buffer,
+                                                   size_t length,
+                                                   ucp_mem_h memh) const {
+  return prepared_stream_send(*this, buffer, length, memh);
 }
 
 stream_recv_awaitable endpoint::stream_recv(void *buffer, size_t length) const {
-  return stream_recv_awaitable(ep_, buffer, length);
+  return track(stream_recv_awaitable(ep_, buffer, length));
 }
 
 tag_send_awaitable endpoint::tag_send(void const *buffer, size_t length,
                                       ucp_tag_t tag) const {
-  return tag_send_awaitable(ep_, buffer, length, tag);
+  return track(tag_send_awaitable(ep_, buffer, length, tag));
+}
+
+prepared_tag_send endpoint::prepare_tag_send(void const *buffer,
+                                             size_t length, ucp_tag_t tag,
+                                             ucp_mem_h memh) const {
+  return prepared_tag_send(*this, buffer, length, tag, memh);
 }
 
 ep_flush_awaitable endpoint::flush() const {
-  return ep_flush_awaitable(this->shared_from_this());
+  return track(ep_flush_awaitable(this->shared_from_this()));
+}
+
+am_send_awaitable endpoint::am_send(unsigned id, void const *header,
+                                    size_t header_length, void const *buffer,
+                                    size_t length, uint32_t flags) const {
+  return track(am_send_awaitable(ep_, id, header, header_length, buffer,
+                                 length, flags));
+}
+
+void endpoint::set_rate_limit(size_t bytes_per_sec, size_t burst) {
+  if (rate_limiter_) {
+    /* Removing the limit keeps the limiter, as suspended paced operations
+     * point to it. It then admits everything at once. */
+    rate_limiter_->set_rate(bytes_per_sec, burst);
+  } else if (bytes_per_sec != 0) {
+    rate_limiter_ =
+        std::make_unique<rate_limiter>(*worker_, bytes_per_sec, burst);
+  }
+}
+
+rate_limiter *endpoint::rate_limiter_ptr() const { return rate_limiter_.get(); }
+
+paced_awaitable<stream_send_awaitable>
+endpoint::paced_stream_send(void const *buffer, size_t length) const {
+  return pace(length, stream_send(buffer, length));
+}
+
+paced_awaitable<tag_send_awaitable>
+endpoint::paced_tag_send(void const *buffer, size_t length,
+                         ucp_tag_t tag) const {
+  return pace(length, tag_send(buffer, length, tag));
 }
 
 task<void> endpoint::close() {
@@ -82,19 +288,6 @@ task<void> endpoint::close() {
   co_return;
 }
 
-void endpoint::close_cb(void *request, ucs_status_t status, void *user_data) {
-  UCXPP_LOG_DEBUG("endpoint closed request=%p status=%s user_data=%p", request,
-                  ::ucs_status_string(status), user_data);
-  ::ucp_request_free(request);
-}
-
-endpoint::~endpoint() {
-  if (ep_ != nullptr && close_request_ == nullptr) {
-    ucp_request_param_t param;
-    param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK;
-    param.cb.send = &close_cb;
-    ::ucp_ep_close_nbx(ep_, &param);
-  }
-}
+endpoint::~endpoint() { release(*worker_); }
 
 } // namespace ucxpp
\ No newline at end of file
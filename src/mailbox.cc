@@ -0,0 +1,48 @@
+#include "ucxpp/mailbox.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <utility>
+
+#include "ucxpp/recv_pool.h"
+#include "ucxpp/worker.h"
+
+namespace ucxpp {
+
+mailbox::recv_awaitable::recv_awaitable(mailbox *mailbox) : mailbox_(mailbox) {}
+
+bool mailbox::recv_awaitable::await_ready() noexcept {
+  if (mailbox_->messages_.empty()) {
+    return false;
+  }
+  buffer_ = std::move(mailbox_->messages_.front());
+  mailbox_->messages_.pop_front();
+  return true;
+}
+
+void mailbox::recv_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  mailbox_->waiters_.push(this);
+}
+
+tag_recv_pool::buffer mailbox::recv_awaitable::await_resume() {
+  return std::move(buffer_);
+}
+
+mailbox::mailbox(worker &worker) : worker_(&worker) {}
+
+void mailbox::push(tag_recv_pool::buffer buffer) {
+  if (!waiters_.empty()) {
+    auto waiter = static_cast<recv_awaitable *>(waiters_.pop());
+    waiter->buffer_ = std::move(buffer);
+    worker_->post(waiter);
+    return;
+  }
+  messages_.push_back(std::move(buffer));
+}
+
+mailbox::recv_awaitable mailbox::recv() { return recv_awaitable(this); }
+
+size_t mailbox::size() const { return messages_.size(); }
+
+} // namespace ucxpp
\ No newline at end of file
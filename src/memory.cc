@@ -89,7 +89,7 @@ packed_memory_rkey::~packed_memory_rkey() {
 
 remote_memory_handle::remote_memory_handle(std::shared_ptr<endpoint> endpoint,
                                            void const *packed_rkey_buffer)
-    : endpoint_(endpoint), ep_(endpoint->handle()) {
+    : endpoint_(endpoint) {
   check_ucs_status(
       ::ucp_ep_rkey_unpack(endpoint_->handle(), packed_rkey_buffer, &rkey_),
       "failed to unpack memory");
@@ -97,9 +97,14 @@ remote_memory_handle::remote_memory_handle(std::shared_ptr<endpoint> endpoint,
 
 remote_memory_handle::remote_memory_handle(remote_memory_handle &&other)
     : endpoint_(std::move(other.endpoint_)),
-      ep_(std::exchange(other.ep_, nullptr)),
       rkey_(std::exchange(other.rkey_, nullptr)) {}
 
+ucp_ep_h remote_memory_handle::ep() const { return endpoint_->ep_; }
+
+void remote_memory_handle::admit(base_awaitable &awaitable) const {
+  endpoint_->admit(awaitable);
+}
+
 std::shared_ptr<endpoint> remote_memory_handle::endpoint_ptr() const {
   return endpoint_;
 }
@@ -108,22 +113,47 @@ ucp_rkey_h remote_memory_handle::handle() const { return rkey_; }
 
 rma_put_awaitable remote_memory_handle::put(void const *buffer, size_t length,
                                             uint64_t raddr) const {
-  return rma_put_awaitable(ep_, buffer, length, raddr, rkey_);
+  return track(rma_put_awaitable(ep(), buffer, length, raddr, rkey_));
 }
 
 rma_get_awaitable remote_memory_handle::get(void *buffer, size_t length,
                                             uint64_t raddr) const {
-  return rma_get_awaitable(ep_, buffer, length, raddr, rkey_);
+  return track(rma_get_awaitable(ep(), buffer, length, raddr, rkey_));
+}
+
+prepared_rma_put remote_memory_handle::prepare_put(void const *buffer,
+                                                   size_t length,
+                                                   uint64_t raddr,
+                                                   ucp_mem_h memh) const {
+  return prepared_rma_put(*endpoint_, buffer, length, raddr, rkey_, memh);
+}
+
+prepared_rma_get remote_memory_handle::prepare_get(void *buffer, size_t length,
+                                                   uint64_t raddr,
+                                                   ucp_mem_h memh) const {
+  return prepared_rma_get(*endpoint_, buffer, length, raddr, rkey_, memh);
+}
+
+paced_awaitable<rma_put_awaitable>
+remote_memory_handle::paced_put(void const *buffer, size_t length,
+                                uint64_t raddr) const {
+  return endpoint_->pace(length, put(buffer, length, raddr));
+}
+
+paced_awaitable<rma_get_awaitable>
+remote_memory_handle::paced_get(void *buffer, size_t length,
+                                uint64_t raddr) const {
+  return endpoint_->pace(length, get(buffer, length, raddr));
 }
 
 rma_put_awaitable remote_memory_handle::write(void const *buffer, size_t length,
                                               uint64_t raddr) const {
-  return rma_put_awaitable(ep_, buffer, length, raddr, rkey_);
+  return put(buffer, length, raddr);
 }
 
 rma_get_awaitable remote_memory_handle::read(void *buffer, size_t length,
                                              uint64_t raddr) const {
-  return rma_get_awaitable(ep_, buffer, length, raddr, rkey_);
+  return get(buffer, length, raddr);
 }
 
 remote_memory_handle::~remote_memory_handle() {
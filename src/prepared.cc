@@ -0,0 +1,112 @@
+#include "ucxpp/prepared.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/endpoint.h"
+
+namespace ucxpp {
+
+prepared_send::prepared_send(endpoint_base const &endpoint, ucp_mem_h memh)
+    : endpoint_(&endpoint) {
+  param_.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                        UCP_OP_ATTR_FIELD_USER_DATA |
+                        UCP_OP_ATTR_FLAG_MULTI_SEND;
+  param_.cb.send = &detail::send_cb<prepared_send>;
+  param_.user_data = this;
+  if (memh != nullptr) {
+    param_.op_attr_mask |= UCP_OP_ATTR_FIELD_MEMH;
+    param_.memh = memh;
+  }
+}
+
+inline ucp_ep_h prepared_send::admit() {
+  assert(status_ != UCS_INPROGRESS);
+  auto ep = endpoint_->ep_;
+  if (ep == nullptr) [[unlikely]] {
+    status_ = endpoint_->status_ != UCS_OK ? endpoint_->status_
+                                           : UCS_ERR_NOT_CONNECTED;
+    return nullptr;
+  }
+  /* The coroutine that awaited the previous submission must not be resumed
+   * by this one */
+  h_ = nullptr;
+  return ep;
+}
+
+inline void prepared_send::issued(ucs_status_ptr_t request) {
+  if (!check_request_ready(request) && endpoint_->track_inflight_)
+      [[unlikely]] {
+    /* A failure of the endpoint clears the owner of tracked operations */
+    owner_ = endpoint_;
+    link_owner();
+  }
+}
+
+void prepared_send::on_complete(ucs_status_t status) {
+  if (owner_ != nullptr) [[unlikely]] {
+    unlink_owner();
+    owner_ = nullptr;
+  }
+  /* The status is kept if the owning endpoint has already failed us */
+  if (status_ == UCS_INPROGRESS) [[likely]] {
+    status_ = status;
+  }
+  if (h_) {
+    detail::resume(std::exchange(h_, nullptr));
+  }
+}
+
+prepared_stream_send::prepared_stream_send(endpoint_base const &endpoint,
+                                           void const *buffer, size_t length,
+                                           ucp_mem_h memh)
+    : prepared_send(endpoint, memh), buffer_(buffer), length_(length) {}
+
+void prepared_stream_send::start() {
+  if (auto ep = admit()) [[likely]] {
+    issued(::ucp_stream_send_nbx(ep, buffer_, length_, &param_));
+  }
+}
+
+prepared_tag_send::prepared_tag_send(endpoint_base const &endpoint,
+                                     void const *buffer, size_t length,
+                                     ucp_tag_t tag, ucp_mem_h memh)
+    : prepared_send(endpoint, memh), buffer_(buffer), length_(length),
+      tag_(tag) {}
+
+void prepared_tag_send::start() {
+  if (auto ep = admit()) [[likely]] {
+    issued(::ucp_tag_send_nbx(ep, buffer_, length_, tag_, &param_));
+  }
+}
+
+prepared_rma_put::prepared_rma_put(endpoint_base const &endpoint,
+                                   void const *buffer, size_t length,
+                                   uint64_t remote_addr, ucp_rkey_h rkey,
+                                   ucp_mem_h memh)
+    : prepared_send(endpoint, memh), buffer_(buffer), length_(length),
+      remote_addr_(remote_addr), rkey_(rkey) {}
+
+void prepared_rma_put::start() {
+  if (auto ep = admit()) [[likely]] {
+    issued(::ucp_put_nbx(ep, buffer_, length_, remote_addr_, rkey_, &param_));
+  }
+}
+
+prepared_rma_get::prepared_rma_get(endpoint_base const &endpoint, void *buffer,
+                                   size_t length, uint64_t remote_addr,
+                                   ucp_rkey_h rkey, ucp_mem_h memh)
+    : prepared_send(endpoint, memh), buffer_(buffer), length_(length),
+      remote_addr_(remote_addr), rkey_(rkey) {}
+
+void prepared_rma_get::start() {
+  if (auto ep = admit()) [[likely]] {
+    issued(::ucp_get_nbx(ep, buffer_, length_, remote_addr_, rkey_, &param_));
+  }
+}
+
+} // namespace ucxpp
\ No newline at end of file
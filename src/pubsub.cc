@@ -0,0 +1,242 @@
+#include "ucxpp/pubsub.h"
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/awaitable.h"
+#include "ucxpp/error.h"
+
+#include "ucxpp/detail/debug.h"
+#include "ucxpp/detail/resume.h"
+#include "ucxpp/detail/serdes.h"
+
+namespace ucxpp {
+
+std::vector<size_t> relay_tree::children(size_t index, size_t members,
+                                         size_t fanout) {
+  std::vector<size_t> result;
+  for (size_t i = 1; i <= fanout; ++i) {
+    auto child = index * fanout + i;
+    if (child >= members) {
+      break;
+    }
+    result.push_back(child);
+  }
+  return result;
+}
+
+size_t relay_tree::parent(size_t index, size_t fanout) {
+  return (index - 1) / fanout;
+}
+
+pubsub_node::fanout_awaitable::fanout_awaitable(
+    unsigned am_id, std::vector<std::shared_ptr<endpoint>> const &targets,
+    uint64_t topic, void const *data, size_t length)
+    : am_id_(am_id), targets_(&targets), data_(data), length_(length),
+      pending_(0), failed_(0) {
+  detail::store(header_.data(), topic);
+}
+
+void pubsub_node::fanout_awaitable::send_cb(void *request, ucs_status_t status,
+                                            void *user_data) {
+  auto self = reinterpret_cast<fanout_awaitable *>(user_data);
+  ::ucp_request_free(request);
+  if (status != UCS_OK) [[unlikely]] {
+    ++self->failed_;
+  }
+  if (--self->pending_ == 0) {
+    detail::resume(self->h_);
+  }
+}
+
+bool pubsub_node::fanout_awaitable::await_ready() noexcept {
+  ucp_request_param_t param;
+  param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                       UCP_OP_ATTR_FIELD_USER_DATA |
+                       UCP_OP_ATTR_FLAG_MULTI_SEND;
+  param.cb.send = &send_cb;
+  param.user_data = this;
+  for (auto const &ep : *targets_) {
+    auto ep_h = ep->handle();
+    if (ep_h == nullptr) [[unlikely]] {
+      /* Closed or failed subscribers are skipped */
+      ++failed_;
+      continue;
+    }
+    auto request = ::ucp_am_send_nbx(ep_h, am_id_, header_.data(),
+                                     header_.size(), data_, length_, &param);
+    if (UCS_PTR_IS_PTR(request)) {
+      ++pending_;
+    } else if (UCS_PTR_IS_ERR(request)) [[unlikely]] {
+      UCXPP_LOG_ERROR("%s", ::ucs_status_string(UCS_PTR_STATUS(request)));
+      ++failed_;
+    }
+  }
+  return pending_ == 0;
+}
+
+bool pubsub_node::fanout_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  return true;
+}
+
+size_t pubsub_node::fanout_awaitable::await_resume() const { return failed_; }
+
+pubsub_node::recv_awaitable::recv_awaitable(pubsub_node *node, uint64_t topic)
+    : node_(node), topic_(topic) {}
+
+bool pubsub_node::recv_awaitable::await_ready() noexcept {
+  auto &state = node_->topics_[topic_];
+  if (state.messages.empty()) {
+    return false;
+  }
+  message_ = std::move(state.messages.front());
+  state.messages.pop_front();
+  return true;
+}
+
+void pubsub_node::recv_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  node_->topics_[topic_].waiters.push(this);
+}
+
+pubsub_node::message pubsub_node::recv_awaitable::await_resume() {
+  return std::move(message_);
+}
+
+pubsub_node::pubsub_node(std::shared_ptr<worker> worker, unsigned am_id)
+    : worker_(worker), am_id_(am_id) {
+  ucp_am_handler_param_t param;
+  param.field_mask =
+      UCP_AM_HANDLER_PARAM_FIELD_ID | UCP_AM_HANDLER_PARAM_FIELD_FLAGS |
+      UCP_AM_HANDLER_PARAM_FIELD_CB | UCP_AM_HANDLER_PARAM_FIELD_ARG;
+  param.id = am_id_;
+  param.flags = UCP_AM_FLAG_WHOLE_MSG;
+  param.cb = &am_cb;
+  param.arg = this;
+  check_ucs_status(::ucp_worker_set_am_recv_handler(worker_->handle(), &param),
+                   "failed to set am handler");
+}
+
+void pubsub_node::add_subscriber(uint64_t topic,
+                                 std::shared_ptr<endpoint> ep) {
+  topics_[topic].subscribers.push_back(std::move(ep));
+}
+
+void pubsub_node::remove_subscriber(uint64_t topic, endpoint const &ep) {
+  auto it = topics_.find(topic);
+  if (it == topics_.end()) {
+    return;
+  }
+  auto &subscribers = it->second.subscribers;
+  subscribers.erase(
+      std::remove_if(subscribers.begin(), subscribers.end(),
+                     [&](auto const &s) { return s.get() == &ep; }),
+      subscribers.end());
+}
+
+size_t pubsub_node::subscribers(uint64_t topic) const {
+  auto it = topics_.find(topic);
+  return it == topics_.end() ? 0 : it->second.subscribers.size();
+}
+
+void pubsub_node::subscribe(uint64_t topic) { topics_[topic].local = true; }
+
+pubsub_node::recv_awaitable pubsub_node::recv(uint64_t topic) {
+  subscribe(topic);
+  return recv_awaitable(this, topic);
+}
+
+pubsub_node::fanout_awaitable
+pubsub_node::publish(uint64_t topic, void const *data, size_t length) {
+  return fanout_awaitable(am_id_, topics_[topic].subscribers, topic, data,
+                          length);
+}
+
+ucs_status_t pubsub_node::am_cb(void *arg, void const *header,
+                                size_t header_length, void *data,
+                                size_t length,
+                                ucp_am_recv_param_t const *param) {
+  auto node = reinterpret_cast<pubsub_node *>(arg);
+  if (header_length != sizeof(uint64_t)) [[unlikely]] {
+    UCXPP_LOG_ERROR("malformed pubsub message");
+    return UCS_OK;
+  }
+  auto topic = detail::load<uint64_t>(header);
+  if (!node->topics_.contains(topic)) {
+    return UCS_OK;
+  }
+  if (param->recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV) {
+    receive(node, topic, std::make_shared<std::vector<char>>(length), data)
+        .detach();
+    return UCS_OK;
+  }
+  auto bytes = static_cast<char const *>(data);
+  receive(node, topic,
+          std::make_shared<std::vector<char>>(bytes, bytes + length), nullptr)
+      .detach();
+  return UCS_OK;
+}
+
+task<void> pubsub_node::receive(pubsub_node *node, uint64_t topic,
+                                std::shared_ptr<std::vector<char>> buffer,
+                                void *rndv_desc) {
+  if (rndv_desc != nullptr) {
+    try {
+      co_await am_recv_data_awaitable(node->worker_->handle(), rndv_desc,
+                                      buffer->data(), buffer->size());
+    } catch (...) {
+      UCXPP_LOG_ERROR("failed to receive pubsub message");
+      co_return;
+    }
+  }
+  /* Relaying and delivery wait until UCX returns in queued completion mode */
+  co_await detail::defer_awaitable();
+  node->dispatch(topic, std::move(buffer));
+}
+
+task<void> pubsub_node::relay(pubsub_node *node, uint64_t topic,
+                              message msg) {
+  auto &subscribers = node->topics_[topic].subscribers;
+  auto failed = co_await fanout_awaitable(node->am_id_, subscribers, topic,
+                                          msg->data(), msg->size());
+  if (failed > 0) [[unlikely]] {
+    UCXPP_LOG_ERROR("failed to relay to %zu subscribers", failed);
+  }
+}
+
+void pubsub_node::dispatch(uint64_t topic, message msg) {
+  auto &state = topics_[topic];
+  if (!state.subscribers.empty()) {
+    relay(this, topic, msg).detach();
+  }
+  if (!state.local) {
+    return;
+  }
+  if (!state.waiters.empty()) {
+    auto waiter = static_cast<recv_awaitable *>(state.waiters.pop());
+    waiter->message_ = std::move(msg);
+    worker_->post(waiter);
+    return;
+  }
+  state.messages.push_back(std::move(msg));
+}
+
+pubsub_node::~pubsub_node() {
+  ucp_am_handler_param_t param;
+  param.field_mask =
+      UCP_AM_HANDLER_PARAM_FIELD_ID | UCP_AM_HANDLER_PARAM_FIELD_CB;
+  param.id = am_id_;
+  param.cb = nullptr;
+  check_ucs_status(::ucp_worker_set_am_recv_handler(worker_->handle(), &param),
+                   "failed to clear am handler");
+}
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "ucxpp/qos.h"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "ucxpp/awaitable.h"
+#include "ucxpp/endpoint.h"
+#include "ucxpp/worker.h"
+
+namespace ucxpp {
+
+bulk_admission_awaitable::bulk_admission_awaitable(qos_scheduler *scheduler)
+    : scheduler_(scheduler), next_(nullptr) {}
+
+bool bulk_admission_awaitable::await_ready() noexcept {
+  return scheduler_->waiters_head_ == nullptr &&
+         scheduler_->bulk_admissible();
+}
+
+void bulk_admission_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  if (scheduler_->waiters_tail_ != nullptr) {
+    scheduler_->waiters_tail_->next_ = this;
+  } else {
+    scheduler_->waiters_head_ = this;
+  }
+  scheduler_->waiters_tail_ = this;
+}
+
+qos_scheduler::qos_scheduler(std::shared_ptr<worker> latency_worker,
+                             std::shared_ptr<worker> bulk_worker,
+                             size_t latency_budget)
+    : workers_{latency_worker, bulk_worker ? bulk_worker : latency_worker},
+      latency_inflight_(0), latency_budget_(latency_budget), pause_bulk_(true),
+      waiters_head_(nullptr), waiters_tail_(nullptr) {}
+
+bool qos_scheduler::bulk_admissible() const {
+  return !pause_bulk_ || latency_inflight_ == 0;
+}
+
+std::shared_ptr<worker> qos_scheduler::worker_ptr(traffic_class cls) const {
+  return workers_[static_cast<size_t>(cls)];
+}
+
+void qos_scheduler::set_pause_bulk(bool pause) { pause_bulk_ = pause; }
+
+size_t qos_scheduler::latency_inflight() const { return latency_inflight_; }
+
+bool qos_scheduler::progress() {
+  bool progressed = false;
+  for (size_t i = 0; i < latency_budget_ && workers_[0]->progress(); ++i) {
+    progressed = true;
+  }
+  if (workers_[1] != workers_[0]) {
+    progressed |= workers_[1]->progress();
+  }
+
+  /* Admitted coroutines may issue latency operations and close the gate */
+  while (waiters_head_ != nullptr && bulk_admissible()) {
+    auto waiter = waiters_head_;
+    waiters_head_ = waiter->next_;
+    if (waiters_head_ == nullptr) {
+      waiters_tail_ = nullptr;
+    }
+    waiter->h_.resume();
+    progressed = true;
+  }
+  return progressed;
+}
+
+bulk_admission_awaitable qos_scheduler::admit_bulk() {
+  return bulk_admission_awaitable(this);
+}
+
+qos_endpoint::qos_endpoint(std::shared_ptr<qos_scheduler> scheduler,
+                           remote_address const &latency_peer,
+                           remote_address const &bulk_peer,
+                           ucp_err_handling_mode_t err_mode)
+    : scheduler_(scheduler),
+      endpoints_{
+          std::make_shared<endpoint>(
+              scheduler->worker_ptr(traffic_class::latency), latency_peer,
+              err_mode),
+          std::make_shared<endpoint>(scheduler->worker_ptr(traffic_class::bulk),
+                                     bulk_peer, err_mode),
+      } {}
+
+qos_endpoint::qos_endpoint(std::shared_ptr<qos_scheduler> scheduler,
+                           remote_address const &peer,
+                           ucp_err_handling_mode_t err_mode)
+    : qos_endpoint(scheduler, peer, peer, err_mode) {}
+
+std::shared_ptr<endpoint> qos_endpoint::endpoint_ptr(traffic_class cls) const {
+  return endpoints_[static_cast<size_t>(cls)];
+}
+
+latency_op<tag_send_awaitable>
+qos_endpoint::tag_send(void const *buffer, size_t length, ucp_tag_t tag) const {
+  return scheduler_->latency(endpoints_[0]->tag_send(buffer, length, tag));
+}
+
+latency_op<stream_send_awaitable>
+qos_endpoint::stream_send(void const *buffer, size_t length) const {
+  return scheduler_->latency(endpoints_[0]->stream_send(buffer, length));
+}
+
+task<void> qos_endpoint::bulk_tag_send(void const *buffer, size_t length,
+                                       ucp_tag_t tag) const {
+  co_await scheduler_->admit_bulk();
+  co_await endpoints_[1]->tag_send(buffer, length, tag);
+}
+
+task<void> qos_endpoint::bulk_stream_send(void const *buffer,
+                                          size_t length) const {
+  co_await scheduler_->admit_bulk();
+  co_await endpoints_[1]->stream_send(buffer, length);
+}
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "ucxpp/rate_limiter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+
+#include "ucxpp/worker.h"
+
+namespace ucxpp {
+
+rate_limit_awaitable::rate_limit_awaitable(rate_limiter *limiter, size_t bytes)
+    : limiter_(limiter), bytes_(bytes), admitted_(nullptr) {}
+
+bool rate_limit_awaitable::await_ready() noexcept {
+  return limiter_->admit_now(bytes_);
+}
+
+void rate_limit_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  limiter_->enqueue(this);
+}
+
+rate_limiter::rate_limiter(worker &worker, size_t bytes_per_sec, size_t burst)
+    : worker_(&worker), bytes_per_sec_(bytes_per_sec), burst_(burst),
+      tokens_(burst), last_refill_(clock::now()), prev_(nullptr),
+      next_(nullptr), linked_(false) {}
+
+void rate_limiter::set_rate(size_t bytes_per_sec, size_t burst) {
+  refill();
+  bytes_per_sec_ = bytes_per_sec;
+  burst_ = burst;
+  tokens_ = std::min(tokens_, burst_);
+  if (bytes_per_sec == 0) {
+    poll();
+  }
+}
+
+void rate_limiter::refill() {
+  auto now = clock::now();
+  std::chrono::duration<double> elapsed = now - last_refill_;
+  last_refill_ = now;
+  tokens_ = std::min(burst_, tokens_ + elapsed.count() * bytes_per_sec_);
+}
+
+bool rate_limiter::try_take(size_t bytes) {
+  if (bytes_per_sec_ == 0) [[unlikely]] {
+    return true;
+  }
+  auto needed = std::min(static_cast<double>(bytes), burst_);
+  if (tokens_ < needed) {
+    refill();
+    if (tokens_ < needed) {
+      return false;
+    }
+  }
+  tokens_ -= bytes;
+  return true;
+}
+
+bool rate_limiter::admit_now(size_t bytes) {
+  return waiters_.empty() && try_take(bytes);
+}
+
+void rate_limiter::enqueue(rate_limit_awaitable *waiter) {
+  waiters_.push(waiter);
+  link();
+}
+
+void rate_limiter::post(detail::waiter *waiter) { worker_->post(waiter); }
+
+void rate_limiter::link() {
+  if (linked_) {
+    return;
+  }
+  prev_ = nullptr;
+  next_ = worker_->pacing_;
+  if (next_ != nullptr) {
+    next_->prev_ = this;
+  }
+  worker_->pacing_ = this;
+  linked_ = true;
+}
+
+void rate_limiter::unlink() {
+  if (!linked_) {
+    return;
+  }
+  if (prev_ != nullptr) {
+    prev_->next_ = next_;
+  } else {
+    worker_->pacing_ = next_;
+  }
+  if (next_ != nullptr) {
+    next_->prev_ = prev_;
+  }
+  prev_ = next_ = nullptr;
+  linked_ = false;
+}
+
+rate_limit_awaitable rate_limiter::acquire(size_t bytes) {
+  return rate_limit_awaitable(this, bytes);
+}
+
+bool rate_limiter::poll() {
+  bool admitted = false;
+  while (!waiters_.empty()) {
+    auto waiter = static_cast<rate_limit_awaitable *>(waiters_.front());
+    if (!try_take(waiter->bytes_)) {
+      break;
+    }
+    waiters_.pop();
+    admitted = true;
+    /* No coroutine runs here, so neither limiter can be destroyed */
+    if (waiter->admitted_ != nullptr) {
+      waiter->admitted_(waiter);
+    } else {
+      worker_->post(waiter);
+    }
+  }
+  if (waiters_.empty()) {
+    unlink();
+  }
+  return admitted;
+}
+
+rate_limiter::~rate_limiter() {
+  assert(waiters_.empty());
+  unlink();
+}
+
+} // namespace ucxpp
\ No newline at end of file
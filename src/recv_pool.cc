@@ -0,0 +1,262 @@
+#include "ucxpp/recv_pool.h"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/error.h"
+
+namespace ucxpp {
+
+tag_recv_pool::tag_recv_pool(std::shared_ptr<worker> worker,
+                             std::vector<size_class> const &classes)
+    : worker_(worker), ready_head_(nullptr), ready_tail_(nullptr), posted_(0),
+      closed_(false) {
+  /* Slots point back to their class, so the vector must not reallocate */
+  classes_.reserve(classes.size());
+  for (auto const &config : classes) {
+    if (config.size == 0 || config.depth == 0 || config.max_chunks == 0) {
+      throw_with("invalid size class: size=%zu depth=%zu max_chunks=%zu",
+                 config.size, config.depth, config.max_chunks);
+    }
+    classes_.push_back(class_state{config, {}, {}, nullptr, 0, false});
+  }
+  for (auto &cls : classes_) {
+    fill(cls);
+  }
+}
+
+tag_recv_pool::tag_recv_pool(std::shared_ptr<worker> worker, size_t size,
+                             size_t depth, ucp_tag_t tag, ucp_tag_t tag_mask,
+                             size_t max_chunks)
+    : tag_recv_pool(worker,
+                    {size_class{size, depth, tag, tag_mask, max_chunks}}) {}
+
+void tag_recv_pool::grow(class_state &cls) {
+  auto const &config = cls.config;
+  auto [memory, mr] = local_memory_handle::allocate_mem(
+      worker_->context_ptr(), config.size * config.depth);
+  auto slots = std::make_unique<slot[]>(config.depth);
+  for (size_t i = 0; i < config.depth; ++i) {
+    auto &s = slots[i];
+    s.pool = this;
+    s.cls = &cls;
+    s.data = static_cast<char *>(memory) + i * config.size;
+    s.request = nullptr;
+    s.length = 0;
+    s.sender_tag = 0;
+    s.status = UCS_OK;
+    s.next = cls.free;
+    cls.free = &s;
+  }
+  cls.mrs.push_back(std::move(mr));
+  cls.slots.push_back(std::move(slots));
+}
+
+void tag_recv_pool::fill(class_state &cls) {
+  while (!closed_ && cls.posted < cls.config.depth) {
+    if (cls.free == nullptr) {
+      if (cls.slots.size() == cls.config.max_chunks) {
+        /* Consumers hold every buffer, release() resumes posting */
+        cls.starved = true;
+        break;
+      }
+      grow(cls);
+    }
+    auto s = cls.free;
+    cls.free = s->next;
+    s->next = nullptr;
+
+    ucp_tag_recv_info_t info;
+    ucp_request_param_t param;
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                         UCP_OP_ATTR_FIELD_USER_DATA |
+                         UCP_OP_ATTR_FIELD_RECV_INFO;
+    param.cb.recv = &recv_cb;
+    param.user_data = s;
+    param.recv_info.tag_info = &info;
+    auto request =
+        ::ucp_tag_recv_nbx(worker_->handle(), s->data, cls.config.size,
+                           cls.config.tag, cls.config.tag_mask, &param);
+    if (UCS_PTR_IS_PTR(request)) {
+      s->request = request;
+      ++cls.posted;
+      ++posted_;
+      continue;
+    }
+    /* Matched an unexpected message, or failed, without a request */
+    auto status = UCS_PTR_STATUS(request);
+    s->status = status;
+    s->length = info.length;
+    s->sender_tag = info.sender_tag;
+    deliver(s);
+    if (status != UCS_OK) [[unlikely]] {
+      break;
+    }
+  }
+}
+
+void tag_recv_pool::recv_cb(void *request, ucs_status_t status,
+                            ucp_tag_recv_info_t const *info, void *user_data) {
+  auto s = reinterpret_cast<slot *>(user_data);
+  auto pool = s->pool;
+  ::ucp_request_free(request);
+  s->request = nullptr;
+  --s->cls->posted;
+  --pool->posted_;
+  if (status == UCS_ERR_CANCELED) {
+    pool->release(s);
+    return;
+  }
+  s->status = status;
+  s->length = info->length;
+  s->sender_tag = info->sender_tag;
+  pool->deliver(s);
+  pool->fill(*s->cls);
+}
+
+void tag_recv_pool::deliver(slot *s) {
+  if (handler_) {
+    if (s->status != UCS_OK) [[unlikely]] {
+      release(s);
+      return;
+    }
+    handler_(buffer(s));
+    return;
+  }
+  if (!waiters_.empty()) {
+    auto waiter = static_cast<recv_awaitable *>(waiters_.pop());
+    waiter->slot_ = s;
+    worker_->post(waiter);
+    return;
+  }
+  s->next = nullptr;
+  if (ready_tail_ != nullptr) {
+    ready_tail_->next = s;
+  } else {
+    ready_head_ = s;
+  }
+  ready_tail_ = s;
+}
+
+void tag_recv_pool::release(slot *s) {
+  auto &cls = *s->cls;
+  s->next = cls.free;
+  cls.free = s;
+  if (cls.starved) {
+    cls.starved = false;
+    fill(cls);
+  }
+}
+
+tag_recv_pool::recv_awaitable tag_recv_pool::recv() {
+  return recv_awaitable(this);
+}
+
+async_generator<tag_recv_pool::buffer> tag_recv_pool::messages() {
+  while (true) {
+    co_yield co_await recv();
+  }
+}
+
+void tag_recv_pool::on_receive(std::function<void(buffer)> handler) {
+  handler_ = std::move(handler);
+  if (!handler_) {
+    return;
+  }
+  /* Receives that matched while posting in the constructor are queued */
+  while (ready_head_ != nullptr) {
+    auto s = ready_head_;
+    ready_head_ = s->next;
+    if (ready_head_ == nullptr) {
+      ready_tail_ = nullptr;
+    }
+    deliver(s);
+  }
+}
+
+size_t tag_recv_pool::posted() const { return posted_; }
+
+tag_recv_pool::~tag_recv_pool() {
+  assert(waiters_.empty());
+  closed_ = true;
+  for (auto &cls : classes_) {
+    for (auto &slots : cls.slots) {
+      for (size_t i = 0; i < cls.config.depth; ++i) {
+        if (slots[i].request != nullptr) {
+          ::ucp_request_cancel(worker_->handle(), slots[i].request);
+        }
+      }
+    }
+  }
+  while (posted_ > 0) {
+    worker_->progress();
+  }
+}
+
+tag_recv_pool::recv_awaitable::recv_awaitable(tag_recv_pool *pool)
+    : pool_(pool), slot_(nullptr) {}
+
+bool tag_recv_pool::recv_awaitable::await_ready() noexcept {
+  if (pool_->ready_head_ == nullptr) {
+    return false;
+  }
+  slot_ = pool_->ready_head_;
+  pool_->ready_head_ = slot_->next;
+  if (pool_->ready_head_ == nullptr) {
+    pool_->ready_tail_ = nullptr;
+  }
+  return true;
+}
+
+void tag_recv_pool::recv_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  pool_->waiters_.push(this);
+}
+
+tag_recv_pool::buffer tag_recv_pool::recv_awaitable::await_resume() {
+  auto status = slot_->status;
+  if (status != UCS_OK) [[unlikely]] {
+    pool_->release(slot_);
+    check_ucs_status(status, "failed to receive to pool");
+  }
+  return buffer(slot_);
+}
+
+tag_recv_pool::buffer::buffer() : slot_(nullptr) {}
+
+tag_recv_pool::buffer::buffer(slot *s) : slot_(s) {}
+
+tag_recv_pool::buffer::buffer(buffer &&other)
+    : slot_(std::exchange(other.slot_, nullptr)) {}
+
+tag_recv_pool::buffer &tag_recv_pool::buffer::operator=(buffer &&other) {
+  if (slot_ != nullptr) {
+    slot_->pool->release(slot_);
+  }
+  slot_ = std::exchange(other.slot_, nullptr);
+  return *this;
+}
+
+void const *tag_recv_pool::buffer::data() const { return slot_->data; }
+
+void *tag_recv_pool::buffer::data() { return slot_->data; }
+
+size_t tag_recv_pool::buffer::length() const { return slot_->length; }
+
+ucp_tag_t tag_recv_pool::buffer::sender_tag() const {
+  return slot_->sender_tag;
+}
+
+tag_recv_pool::buffer::~buffer() {
+  if (slot_ != nullptr) {
+    slot_->pool->release(slot_);
+  }
+}
+
+} // namespace ucxpp
\ No newline at end of file
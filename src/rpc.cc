@@ -0,0 +1,321 @@
+#include "ucxpp/rpc.h"
+
+#include <array>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/awaitable.h"
+#include "ucxpp/error.h"
+
+#include "ucxpp/detail/debug.h"
+#include "ucxpp/detail/resume.h"
+#include "ucxpp/detail/serdes.h"
+
+namespace ucxpp {
+
+namespace {
+
+constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+/* method, status, request id */
+using wire_header = detail::flat_struct<uint32_t, uint32_t, uint64_t>;
+static_assert(wire_header::kSize == kRpcHeaderSize);
+
+std::array<char, kRpcHeaderSize>
+pack_header(uint32_t method, ucs_status_t status, uint64_t request_id) {
+  std::array<char, kRpcHeaderSize> header;
+  wire_header::pack(header.data(), method, static_cast<uint32_t>(status),
+                    request_id);
+  return header;
+}
+
+bool unpack_header(void const *header, size_t header_length, uint32_t &method,
+                   ucs_status_t &status, uint64_t &request_id) {
+  if (header_length != kRpcHeaderSize) [[unlikely]] {
+    return false;
+  }
+  uint32_t raw_status;
+  std::tie(method, raw_status, request_id) = wire_header::unpack(header);
+  status = static_cast<ucs_status_t>(static_cast<int32_t>(raw_status));
+  return true;
+}
+
+void set_am_handler(ucp_worker_h worker, unsigned id, ucp_am_recv_callback_t cb,
+                    void *arg) {
+  ucp_am_handler_param_t param;
+  param.field_mask = UCP_AM_HANDLER_PARAM_FIELD_ID |
+                     UCP_AM_HANDLER_PARAM_FIELD_FLAGS |
+                     UCP_AM_HANDLER_PARAM_FIELD_CB |
+                     UCP_AM_HANDLER_PARAM_FIELD_ARG;
+  param.id = id;
+  param.flags = UCP_AM_FLAG_WHOLE_MSG;
+  param.cb = cb;
+  param.arg = arg;
+  check_ucs_status(::ucp_worker_set_am_recv_handler(worker, &param),
+                   "failed to set am handler");
+}
+
+} // namespace
+
+rpc_server::rpc_server(std::shared_ptr<worker> worker, unsigned am_id,
+                       size_t zcopy_threshold)
+    : worker_(worker), am_id_(am_id), zcopy_threshold_(zcopy_threshold) {
+  set_am_handler(worker_->handle(), am_id_, &request_cb, this);
+}
+
+void rpc_server::register_method(uint32_t method, rpc_handler handler) {
+  handlers_[method] = std::move(handler);
+}
+
+ucs_status_t rpc_server::request_cb(void *arg, void const *header,
+                                    size_t header_length, void *data,
+                                    size_t length,
+                                    ucp_am_recv_param_t const *param) {
+  auto server = reinterpret_cast<rpc_server *>(arg);
+  uint32_t method;
+  ucs_status_t status;
+  uint64_t request_id;
+  if (!unpack_header(header, header_length, method, status, request_id) ||
+      !(param->recv_attr & UCP_AM_RECV_ATTR_FIELD_REPLY_EP)) [[unlikely]] {
+    UCXPP_LOG_ERROR("malformed rpc request");
+    return UCS_OK;
+  }
+  if (param->recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV) {
+    /*
+     * Tasks start eagerly, so serve() calls ucp_am_recv_data_nbx on the
+     * descriptor before this callback returns
+     */
+    serve(server, param->reply_ep, method, request_id, rpc_payload(length),
+          data)
+        .detach();
+    return UCS_OK;
+  }
+  auto bytes = static_cast<char const *>(data);
+  serve(server, param->reply_ep, method, request_id,
+        rpc_payload(bytes, bytes + length), nullptr)
+      .detach();
+  return UCS_OK;
+}
+
+task<void> rpc_server::serve(rpc_server *server, ucp_ep_h reply_ep,
+                             uint32_t method, uint64_t request_id,
+                             rpc_payload args, void *rndv_desc) {
+  auto status = UCS_OK;
+  rpc_payload result;
+  try {
+    if (rndv_desc != nullptr) {
+      co_await am_recv_data_awaitable(server->worker_->handle(), rndv_desc,
+                                      args.data(), args.size());
+    }
+    /* The handler runs after UCX returns in queued completion mode */
+    co_await detail::defer_awaitable();
+    auto it = server->handlers_.find(method);
+    if (it == server->handlers_.end()) {
+      status = UCS_ERR_UNSUPPORTED;
+    } else {
+      result = co_await it->second(std::move(args));
+    }
+  } catch (...) {
+    status = UCS_ERR_IO_ERROR;
+  }
+
+  auto header = pack_header(method, status, request_id);
+  uint32_t flags =
+      result.size() >= server->zcopy_threshold_ ? UCP_AM_SEND_FLAG_RNDV : 0;
+  try {
+    co_await am_send_awaitable(reply_ep, server->am_id_ + 1, header.data(),
+                               header.size(), result.data(), result.size(),
+                               flags);
+  } catch (...) {
+    UCXPP_LOG_ERROR("failed to send rpc reply");
+  }
+}
+
+rpc_server::~rpc_server() {
+  set_am_handler(worker_->handle(), am_id_, nullptr, nullptr);
+}
+
+rpc_call_awaitable::rpc_call_awaitable(rpc_client *client,
+                                       endpoint const &ep, uint32_t method,
+                                       void const *args, size_t length)
+    : client_(client), endpoint_(&ep), method_(method), args_(args),
+      length_(length), slot_(kNoSlot), pending_(0), replied_(false),
+      status_(UCS_OK), hook_(&on_failure, this) {}
+
+void rpc_call_awaitable::send_cb(void *request, ucs_status_t status,
+                                 void *user_data) {
+  auto self = reinterpret_cast<rpc_call_awaitable *>(user_data);
+  ::ucp_request_free(request);
+  if (status != UCS_OK && !self->replied_) [[unlikely]] {
+    /* No reply will come for a request that was not sent */
+    self->status_ = status;
+    self->client_->release_slot(self->slot_);
+    self->pending_ = 1;
+  }
+  self->complete_one();
+}
+
+void rpc_call_awaitable::on_failure(void *arg, ucs_status_t status) {
+  auto self = reinterpret_cast<rpc_call_awaitable *>(arg);
+  if (self->replied_) {
+    /* The reply is in, and a pending send is completed by UCX */
+    return;
+  }
+  /* No reply will come over a failed endpoint */
+  self->replied_ = true;
+  self->status_ = status;
+  self->client_->release_slot(self->slot_);
+  self->complete_one();
+}
+
+void rpc_call_awaitable::complete_one() {
+  if (--pending_ == 0) {
+    hook_.remove();
+    detail::resume(h_);
+  }
+}
+
+bool rpc_call_awaitable::await_ready() noexcept {
+  auto ep = endpoint_->handle();
+  if (ep == nullptr) [[unlikely]] {
+    auto status = endpoint_->status();
+    status_ = status != UCS_OK ? status : UCS_ERR_NOT_CONNECTED;
+    return true;
+  }
+  auto request_id = client_->acquire_slot(this);
+  slot_ = static_cast<uint32_t>(request_id);
+  header_ = pack_header(method_, UCS_OK, request_id);
+
+  ucp_request_param_t param;
+  param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                       UCP_OP_ATTR_FIELD_USER_DATA | UCP_OP_ATTR_FIELD_FLAGS;
+  param.cb.send = &send_cb;
+  param.user_data = this;
+  param.flags = UCP_AM_SEND_FLAG_REPLY;
+  if (length_ >= client_->zcopy_threshold_) {
+    param.flags |= UCP_AM_SEND_FLAG_RNDV;
+  }
+  auto request = ::ucp_am_send_nbx(ep, client_->am_id_, header_.data(),
+                                   header_.size(), args_, length_, &param);
+  if (UCS_PTR_IS_ERR(request)) [[unlikely]] {
+    status_ = UCS_PTR_STATUS(request);
+    client_->release_slot(slot_);
+    return true;
+  }
+  pending_ = UCS_PTR_IS_PTR(request) ? 2 : 1;
+  endpoint_->add_failure_hook(hook_);
+  return false;
+}
+
+bool rpc_call_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  return pending_ > 0;
+}
+
+rpc_payload rpc_call_awaitable::await_resume() {
+  check_ucs_status(status_, "rpc call failed");
+  return std::move(reply_);
+}
+
+rpc_client::rpc_client(std::shared_ptr<worker> worker, unsigned am_id,
+                       size_t zcopy_threshold)
+    : worker_(worker), am_id_(am_id), zcopy_threshold_(zcopy_threshold),
+      free_(kNoSlot) {
+  set_am_handler(worker_->handle(), am_id_ + 1, &reply_cb, this);
+}
+
+uint64_t rpc_client::acquire_slot(rpc_call_awaitable *call) {
+  if (free_ == kNoSlot) {
+    free_ = static_cast<uint32_t>(calls_.size());
+    calls_.push_back(pending_call{nullptr, 0, kNoSlot});
+  }
+  auto slot = free_;
+  auto &entry = calls_[slot];
+  free_ = entry.next_free;
+  entry.call = call;
+  return static_cast<uint64_t>(entry.generation) << 32 | slot;
+}
+
+void rpc_client::release_slot(uint32_t slot) {
+  auto &entry = calls_[slot];
+  entry.call = nullptr;
+  /* Late replies carrying the old generation are dropped */
+  ++entry.generation;
+  entry.next_free = free_;
+  free_ = slot;
+}
+
+ucs_status_t rpc_client::reply_cb(void *arg, void const *header,
+                                  size_t header_length, void *data,
+                                  size_t length,
+                                  ucp_am_recv_param_t const *param) {
+  auto client = reinterpret_cast<rpc_client *>(arg);
+  uint32_t method;
+  ucs_status_t status;
+  uint64_t request_id;
+  if (!unpack_header(header, header_length, method, status, request_id))
+      [[unlikely]] {
+    UCXPP_LOG_ERROR("malformed rpc reply");
+    return UCS_OK;
+  }
+  auto slot = static_cast<uint32_t>(request_id);
+  auto generation = static_cast<uint32_t>(request_id >> 32);
+  if (slot >= client->calls_.size() ||
+      client->calls_[slot].generation != generation ||
+      client->calls_[slot].call == nullptr) [[unlikely]] {
+    return UCS_OK;
+  }
+  auto call = client->calls_[slot].call;
+  client->release_slot(slot);
+  call->replied_ = true;
+  call->status_ = status;
+  if (param->recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV) {
+    call->reply_.resize(length);
+    /* Started eagerly, so the data is requested inside this callback */
+    receive_reply(client->worker_->handle(), data, call).detach();
+    return UCS_OK;
+  }
+  auto bytes = static_cast<char const *>(data);
+  call->reply_.assign(bytes, bytes + length);
+  call->complete_one();
+  return UCS_OK;
+}
+
+task<void> rpc_client::receive_reply(ucp_worker_h worker, void *rndv_desc,
+                                     rpc_call_awaitable *call) {
+  try {
+    co_await am_recv_data_awaitable(worker, rndv_desc, call->reply_.data(),
+                                    call->reply_.size());
+  } catch (...) {
+    call->status_ = UCS_ERR_IO_ERROR;
+  }
+  call->complete_one();
+}
+
+rpc_call_awaitable rpc_client::call(endpoint const &ep, uint32_t method,
+                                    void const *args, size_t length) {
+  return rpc_call_awaitable(this, ep, method, args, length);
+}
+
+size_t rpc_client::in_flight() const {
+  size_t n = 0;
+  for (auto const &entry : calls_) {
+    n += entry.call != nullptr;
+  }
+  return n;
+}
+
+rpc_client::~rpc_client() {
+  assert(in_flight() == 0);
+  set_am_handler(worker_->handle(), am_id_ + 1, nullptr, nullptr);
+}
+
+} // namespace ucxpp
\ No newline at end of file
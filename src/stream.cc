@@ -0,0 +1,250 @@
+#include "ucxpp/stream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include <ucp/api/ucp.h>
+
+#include "ucxpp/error.h"
+
+#include "ucxpp/detail/serdes.h"
+
+namespace ucxpp {
+
+void stream_writer::idle_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  writer_->waiters_.push(this);
+}
+
+stream_writer::stream_writer(std::shared_ptr<endpoint> endpoint,
+                             size_t capacity, size_t depth)
+    : endpoint_(endpoint), capacity_(capacity), current_(0) {
+  if (depth == 0 || capacity <= sizeof(length_type)) {
+    throw_with("invalid stream writer depth %zu or capacity %zu", depth,
+               capacity);
+  }
+  auto ctx = endpoint_->worker_ptr()->context_ptr();
+  mrs_.reserve(depth);
+  segments_.reserve(depth);
+  for (size_t i = 0; i < depth; ++i) {
+    auto [buffer, mr] = local_memory_handle::allocate_mem(ctx, capacity);
+    mrs_.push_back(std::move(mr));
+    segments_.push_back(segment{static_cast<char *>(buffer), 0, false});
+  }
+}
+
+stream_writer::segment *stream_writer::seal() {
+  auto &s = segments_[current_];
+  if (s.in_flight || s.used == 0) {
+    return nullptr;
+  }
+  s.in_flight = true;
+  current_ = (current_ + 1) % segments_.size();
+  return &s;
+}
+
+task<void> stream_writer::send_segment(segment *s) {
+  try {
+    co_await endpoint_->stream_send(s->buffer, s->used);
+  } catch (...) {
+    error_ = std::current_exception();
+  }
+  s->used = 0;
+  s->in_flight = false;
+  endpoint_->worker_ptr()->post(waiters_);
+}
+
+void stream_writer::check_length(size_t length) {
+  if (length > std::numeric_limits<length_type>::max()) [[unlikely]] {
+    throw_with("frame of %zu bytes does not fit the length prefix", length);
+  }
+}
+
+bool stream_writer::try_write(void const *data, size_t length) {
+  if (error_) [[unlikely]] {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+  check_length(length);
+  auto frame = sizeof(length_type) + length;
+  if (frame > capacity_ || segments_[current_].in_flight) {
+    return false;
+  }
+  if (segments_[current_].used + frame > capacity_) {
+    send_segment(seal()).detach();
+    if (segments_[current_].in_flight) {
+      return false;
+    }
+  }
+  auto &s = segments_[current_];
+  detail::store(s.buffer + s.used, static_cast<length_type>(length));
+  std::memcpy(s.buffer + s.used + sizeof(length_type), data, length);
+  s.used += frame;
+  return true;
+}
+
+task<void> stream_writer::write(void const *data, size_t length) {
+  check_length(length);
+  if (sizeof(length_type) + length > capacity_) {
+    /* Stream sends are ordered, so the buffered frames go out first */
+    if (auto s = seal()) {
+      send_segment(s).detach();
+    }
+    char header[sizeof(length_type)];
+    detail::store(header, static_cast<length_type>(length));
+    /* One send for header and payload, as a segment sealed by another
+     * coroutine in between would split the frame */
+    ucp_dt_iov_t iov[2] = {{header, sizeof(header)},
+                           {const_cast<void *>(data), length}};
+    co_await endpoint_->stream_sendv(iov, 2);
+    co_return;
+  }
+  while (!try_write(data, length)) {
+    co_await idle_awaitable(this);
+  }
+}
+
+task<void> stream_writer::flush() {
+  if (auto s = seal()) {
+    send_segment(s).detach();
+  }
+  while (in_flight() > 0) {
+    co_await idle_awaitable(this);
+  }
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+size_t stream_writer::in_flight() const {
+  size_t n = 0;
+  for (auto const &s : segments_) {
+    n += s.in_flight;
+  }
+  return n;
+}
+
+stream_writer::~stream_writer() {
+  assert(in_flight() == 0);
+  assert(waiters_.empty());
+}
+
+stream_reader::stream_reader(std::shared_ptr<endpoint> endpoint,
+                             size_t capacity, size_t max_frame)
+    : endpoint_(endpoint), capacity_(std::max<size_t>(capacity, 64)),
+      max_frame_(max_frame), begin_(0), end_(0) {
+  auto [buffer, mr] = local_memory_handle::allocate_mem(
+      endpoint_->worker_ptr()->context_ptr(), capacity_);
+  buffer_ = static_cast<char *>(buffer);
+  mr_.emplace(std::move(mr));
+}
+
+task<void> stream_reader::fill(size_t length) {
+  if (end_ - begin_ >= length) {
+    co_return;
+  }
+  if (begin_ == end_) {
+    begin_ = end_ = 0;
+  }
+  if (length > capacity_) {
+    auto capacity = std::max(length, capacity_ * 2);
+    auto [buffer, mr] = local_memory_handle::allocate_mem(
+        endpoint_->worker_ptr()->context_ptr(), capacity);
+    std::memcpy(buffer, buffer_ + begin_, end_ - begin_);
+    buffer_ = static_cast<char *>(buffer);
+    mr_.emplace(std::move(mr));
+    capacity_ = capacity;
+    end_ -= begin_;
+    begin_ = 0;
+  } else if (begin_ + length > capacity_) {
+    std::memmove(buffer_, buffer_ + begin_, end_ - begin_);
+    end_ -= begin_;
+    begin_ = 0;
+  }
+  while (end_ - begin_ < length) {
+    end_ += co_await endpoint_->stream_recv(buffer_ + end_, capacity_ - end_);
+  }
+}
+
+size_t stream_reader::frame_length() const {
+  using length_type = stream_writer::length_type;
+  auto length = detail::load<length_type>(buffer_ + begin_);
+  if (length > max_frame_) [[unlikely]] {
+    throw_with("frame of %zu bytes exceeds the maximum of %zu",
+               static_cast<size_t>(length), max_frame_);
+  }
+  return length;
+}
+
+bool stream_reader::take_frame(std::span<char const> &frame) {
+  using length_type = stream_writer::length_type;
+  if (end_ - begin_ < sizeof(length_type)) {
+    return false;
+  }
+  auto length = frame_length();
+  if (end_ - begin_ < sizeof(length_type) + length) {
+    return false;
+  }
+  frame = std::span<char const>(buffer_ + begin_ + sizeof(length_type), length);
+  begin_ += sizeof(length_type) + length;
+  return true;
+}
+
+task<void> stream_reader::fill_frame() {
+  using length_type = stream_writer::length_type;
+  co_await fill(sizeof(length_type));
+  co_await fill(sizeof(length_type) + frame_length());
+}
+
+stream_reader::frame_awaitable stream_reader::read_frame() {
+  return frame_awaitable(this);
+}
+
+bool stream_reader::frame_awaitable::await_ready() {
+  return reader_->take_frame(frame_);
+}
+
+bool stream_reader::frame_awaitable::await_suspend(std::coroutine_handle<> h) {
+  /* Only a drained buffer costs a coroutine, which receives a whole batch */
+  fill_.emplace(reader_->fill_frame());
+  auto awaiter = fill_->operator co_await();
+  if (awaiter.await_ready()) {
+    return false;
+  }
+  awaiter.await_suspend(h);
+  return true;
+}
+
+std::span<char const> stream_reader::frame_awaitable::await_resume() {
+  if (fill_) {
+    fill_->operator co_await().await_resume();
+    auto taken = reader_->take_frame(frame_);
+    assert(taken);
+    (void)taken;
+  }
+  return frame_;
+}
+
+task<std::span<char const>> stream_reader::read(size_t length) {
+  co_await fill(length);
+  auto bytes = std::span<char const>(buffer_ + begin_, length);
+  begin_ += length;
+  co_return bytes;
+}
+
+async_generator<std::span<char const>> stream_reader::frames() {
+  while (true) {
+    co_yield co_await read_frame();
+  }
+}
+
+size_t stream_reader::buffered() const { return end_ - begin_; }
+
+} // namespace ucxpp
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "ucxpp/sync.h"
+
+#include <coroutine>
+#include <cstddef>
+
+#include "ucxpp/worker.h"
+
+namespace ucxpp {
+
+bool async_mutex::lock_awaitable::await_ready() noexcept {
+  return mutex_->try_lock();
+}
+
+void async_mutex::lock_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  mutex_->waiters_.push(this);
+}
+
+async_mutex::async_mutex(worker &worker) : worker_(&worker), locked_(false) {}
+
+async_mutex::lock_awaitable async_mutex::lock() { return lock_awaitable(this); }
+
+bool async_mutex::try_lock() {
+  if (locked_) {
+    return false;
+  }
+  locked_ = true;
+  return true;
+}
+
+void async_mutex::unlock() {
+  if (waiters_.empty()) {
+    locked_ = false;
+    return;
+  }
+  /* The mutex stays locked on behalf of the next waiter */
+  worker_->post(waiters_.pop());
+}
+
+bool async_semaphore::acquire_awaitable::await_ready() noexcept {
+  return semaphore_->waiters_.empty() && semaphore_->try_acquire();
+}
+
+void async_semaphore::acquire_awaitable::await_suspend(
+    std::coroutine_handle<> h) {
+  h_ = h;
+  semaphore_->waiters_.push(this);
+}
+
+async_semaphore::async_semaphore(worker &worker, size_t count)
+    : worker_(&worker), count_(count) {}
+
+async_semaphore::acquire_awaitable async_semaphore::acquire() {
+  return acquire_awaitable(this);
+}
+
+bool async_semaphore::try_acquire() {
+  if (count_ == 0) {
+    return false;
+  }
+  --count_;
+  return true;
+}
+
+void async_semaphore::release(size_t n) {
+  for (; n > 0 && !waiters_.empty(); --n) {
+    worker_->post(waiters_.pop());
+  }
+  count_ += n;
+}
+
+size_t async_semaphore::count() const { return count_; }
+
+bool async_event::wait_awaitable::await_ready() noexcept {
+  return event_->set_;
+}
+
+void async_event::wait_awaitable::await_suspend(std::coroutine_handle<> h) {
+  h_ = h;
+  event_->waiters_.push(this);
+}
+
+async_event::async_event(worker &worker, bool set)
+    : worker_(&worker), set_(set) {}
+
+async_event::wait_awaitable async_event::wait() { return wait_awaitable(this); }
+
+void async_event::set() {
+  set_ = true;
+  worker_->post(waiters_);
+}
+
+void async_event::reset() { set_ = false; }
+
+bool async_event::is_set() const { return set_; }
+
+} // namespace ucxpp
\ No newline at end of file
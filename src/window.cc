@@ -0,0 +1,108 @@
+#include "ucxpp/window.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+#include "ucxpp/worker.h"
+
+namespace ucxpp {
+
+/* Windows of completions without bandwidth gain that make a plateau */
+constexpr size_t kPlateauEpochs = 3;
+
+window_controller::window_controller(worker &worker,
+                                     window_options const &options)
+    : worker_(&worker), options_(options), in_flight_(0), srtt_ns_(0),
+      since_decrease_(0), epoch_ops_(0), epoch_bytes_(0),
+      epoch_start_(clock::now()), best_bandwidth_(0), flat_epochs_(0) {
+  options_.min = std::max<size_t>(options_.min, 1);
+  options_.max = std::max(options_.max, options_.min);
+  window_ = std::clamp(options_.initial, options_.min, options_.max);
+}
+
+bool window_controller::try_admit() {
+  if (in_flight_ >= static_cast<size_t>(window_)) {
+    return false;
+  }
+  ++in_flight_;
+  return true;
+}
+
+void window_controller::complete(clock::time_point start, size_t bytes) {
+  auto now = clock::now();
+  --in_flight_;
+  on_sample(std::chrono::duration<double, std::nano>(now - start).count(),
+            bytes);
+  while (!waiters_.empty() && try_admit()) {
+    auto waiter = static_cast<window_waiter *>(waiters_.pop());
+    waiter->admit_(waiter);
+  }
+}
+
+void window_controller::on_sample(double latency_ns, size_t bytes) {
+  /* Same smoothing as TCP's SRTT */
+  srtt_ns_ =
+      srtt_ns_ == 0 ? latency_ns : srtt_ns_ + (latency_ns - srtt_ns_) / 8;
+  ++since_decrease_;
+  auto decrease = [this]() {
+    window_ = std::max(window_ * options_.decrease,
+                       static_cast<double>(options_.min));
+    since_decrease_ = 0;
+  };
+  auto increase = [this]() {
+    window_ = std::min(window_ + 1.0 / window_,
+                       static_cast<double>(options_.max));
+  };
+
+  if (options_.target_latency.count() > 0) {
+    /* At most one decrease per window of completions */
+    if (srtt_ns_ > options_.target_latency.count()) {
+      if (since_decrease_ >= window_) {
+        decrease();
+      }
+    } else {
+      increase();
+    }
+    return;
+  }
+
+  /* Bandwidth mode compares consecutive windows of completions */
+  ++epoch_ops_;
+  epoch_bytes_ += bytes;
+  if (epoch_ops_ < window_) {
+    increase();
+    return;
+  }
+  auto now = clock::now();
+  std::chrono::duration<double> elapsed = now - epoch_start_;
+  auto amount = epoch_bytes_ > 0 ? epoch_bytes_ : epoch_ops_;
+  auto bandwidth = amount / elapsed.count();
+  if (bandwidth > best_bandwidth_ * (1 + options_.plateau_gain)) {
+    best_bandwidth_ = bandwidth;
+    flat_epochs_ = 0;
+    increase();
+  } else if (++flat_epochs_ >= kPlateauEpochs) {
+    /* Back off, then probe again from the bandwidth at the smaller window */
+    decrease();
+    best_bandwidth_ = bandwidth;
+    flat_epochs_ = 0;
+  } else {
+    increase();
+  }
+  epoch_ops_ = 0;
+  epoch_bytes_ = 0;
+  epoch_start_ = now;
+}
+
+size_t window_controller::window() const {
+  return static_cast<size_t>(window_);
+}
+
+size_t window_controller::in_flight() const { return in_flight_; }
+
+std::chrono::nanoseconds window_controller::smoothed_latency() const {
+  return std::chrono::nanoseconds(static_cast<long>(srtt_ns_));
+}
+
+} // namespace ucxpp
\ No newline at end of file
@@ -1,10 +1,12 @@
 #include "ucxpp/worker.h"
 
 #include <cassert>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
 #include <ucs/type/status.h>
 #include <ucs/type/thread_mode.h>
 #include <unordered_map>
@@ -13,13 +15,25 @@
 
 #include "ucxpp/address.h"
 #include "ucxpp/awaitable.h"
+#include "ucxpp/endpoint.h"
 #include "ucxpp/error.h"
+#include "ucxpp/rate_limiter.h"
 
 #include "ucxpp/detail/debug.h"
+#include "ucxpp/detail/resume.h"
 
 namespace ucxpp {
 
-worker::worker(std::shared_ptr<context> ctx) : ctx_(ctx), event_fd_(-1) {
+namespace detail {
+
+thread_local resume_ring *deferred_resumes = nullptr;
+
+} // namespace detail
+
+worker::worker(std::shared_ptr<context> ctx)
+    : ctx_(ctx), event_fd_(-1), endpoints_(nullptr), num_endpoints_(0),
+      closing_(nullptr), pacing_(nullptr), queue_completions_(false),
+      completion_budget_(0) {
   ucp_worker_params_t worker_params;
   worker_params.field_mask = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
   worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
@@ -48,13 +62,109 @@ local_address worker::get_address() const {
 
 ucp_worker_h worker::handle() const { return worker_; }
 
-bool worker::progress() const { return ::ucp_worker_progress(worker_); }
+size_t worker::num_endpoints() const { return num_endpoints_; }
+
+void worker::link_endpoint(endpoint_base *ep) {
+  ep->prev_ = nullptr;
+  ep->next_ = endpoints_;
+  if (endpoints_ != nullptr) {
+    endpoints_->prev_ = ep;
+  }
+  endpoints_ = ep;
+  ++num_endpoints_;
+}
+
+void worker::unlink_endpoint(endpoint_base *ep) {
+  if (ep->prev_ != nullptr) {
+    ep->prev_->next_ = ep->next_;
+  } else {
+    endpoints_ = ep->next_;
+  }
+  if (ep->next_ != nullptr) {
+    ep->next_->prev_ = ep->prev_;
+  }
+  ep->prev_ = ep->next_ = nullptr;
+  --num_endpoints_;
+}
+
+void worker::set_rate_limit(size_t bytes_per_sec, size_t burst) {
+  if (rate_limiter_) {
+    /* Removing the limit keeps the limiter, as suspended paced operations
+     * point to it. It then admits everything at once. */
+    rate_limiter_->set_rate(bytes_per_sec, burst);
+  } else if (bytes_per_sec != 0) {
+    rate_limiter_ = std::make_unique<rate_limiter>(*this, bytes_per_sec, burst);
+  }
+}
+
+rate_limiter *worker::rate_limiter_ptr() const { return rate_limiter_.get(); }
+
+void worker::post(detail::waiter *waiter) { ready_.push(waiter); }
+
+void worker::post(detail::waiter_queue &waiters) { waiters.splice_to(ready_); }
+
+void worker::set_completion_mode(completion_mode mode, size_t budget) {
+  assert(mode == completion_mode::inline_resume || budget > 0);
+  queue_completions_ = mode == completion_mode::queued;
+  completion_budget_ = budget;
+}
+
+size_t worker::queued_completions() const { return completions_.size(); }
+
+void worker::drain_completions() const {
+  /* Completions left over from queued mode are all resumed in inline mode */
+  auto budget = queue_completions_ ? completion_budget_ : completions_.size();
+  for (; budget > 0 && !completions_.empty(); --budget) {
+    completions_.pop().resume();
+  }
+}
+
+bool worker::progress() const {
+  bool progressed;
+  if (queue_completions_) [[unlikely]] {
+    detail::defer_resumes guard(&completions_);
+    progressed = ::ucp_worker_progress(worker_);
+  } else {
+    progressed = ::ucp_worker_progress(worker_);
+  }
+  if (closing_ != nullptr) [[unlikely]] {
+    closing_->check_deadline();
+  }
+  for (auto limiter = pacing_; limiter != nullptr;) {
+    auto next = limiter->next_;
+    progressed |= limiter->poll();
+    limiter = next;
+  }
+  if (!ready_.empty()) {
+    /* Waiters posted while draining wait for the next call */
+    detail::waiter_queue ready;
+    ready_.splice_to(ready);
+    while (!ready.empty()) {
+      ready.pop()->h_.resume();
+    }
+    progressed = true;
+  }
+  if (!completions_.empty()) [[unlikely]] {
+    drain_completions();
+    progressed = true;
+  }
+  return progressed;
+}
 
 void worker::wait() const {
   check_ucs_status(::ucp_worker_wait(worker_), "failed to wait worker");
 }
 
 bool worker::arm() const {
+  /* Posted waiters only run in progress(), and tokens owed to paced
+   * operations arrive with time, not with events */
+  if (!ready_.empty() || !completions_.empty() || pacing_ != nullptr) {
+    return false;
+  }
+  /* The next progress() force closes what close_all() has left */
+  if (closing_ != nullptr && closing_->past_deadline()) [[unlikely]] {
+    return false;
+  }
   auto status = ::ucp_worker_arm(worker_);
   if (status == UCS_ERR_BUSY) {
     return false;
@@ -68,6 +178,14 @@ tag_recv_awaitable worker::tag_recv(void *buffer, size_t length, ucp_tag_t tag,
   return tag_recv_awaitable(worker_, buffer, length, tag, tag_mask);
 }
 
+async_generator<std::pair<size_t, ucp_tag_t>>
+worker::tag_recv_stream(void *buffer, size_t length, ucp_tag_t tag,
+                        ucp_tag_t tag_mask) const {
+  while (true) {
+    co_yield co_await tag_recv(buffer, length, tag, tag_mask);
+  }
+}
+
 void worker::fence() {
   check_ucs_status(::ucp_worker_fence(worker_), "failed to fence worker");
 }
@@ -76,6 +194,12 @@ worker_flush_awaitable worker::flush() {
   return worker_flush_awaitable(this->shared_from_this());
 }
 
+worker_close_all_awaitable
+worker::close_all(ucp_ep_close_mode mode,
+                  std::chrono::steady_clock::time_point deadline) {
+  return worker_close_all_awaitable(this->shared_from_this(), mode, deadline);
+}
+
 worker::~worker() { ::ucp_worker_destroy(worker_); }
 
 } // namespace ucxpp
\ No newline at end of file